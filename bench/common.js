@@ -0,0 +1,111 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+function elapsedNs(start) {
+	var diff = process.hrtime(start);
+	return diff[0] * 1e9 + diff[1];
+}
+
+function report(name, ops, ns) {
+	var perOp = ns / ops;
+	var unit = perOp >= 1e6 ? (perOp / 1e6).toFixed(2) + ' ms' : perOp >= 1e3 ? (perOp / 1e3).toFixed(2) + ' us' : perOp.toFixed(0) + ' ns';
+	console.log('  ' + name + new Array(Math.max(2, 40 - name.length)).join(' ') + unit + '/op\t' + Math.round(ops / (ns / 1e9)) + ' ops/s');
+}
+
+/*
+ * Runs the benchmarks of a suite one after another. Each benchmark is
+ *  {
+ *  	name: <reported name>,
+ *  	ops: <number of calls to fn>,
+ *  	fn: function(i) or function(i, cb) for asynchronous benchmarks,
+ *  	concurrency: <asynchronous calls kept in flight, default 1>
+ *  }
+ */
+function runSuite(name, benchmarks, filter, cb) {
+	console.log(name);
+
+	var index = 0;
+	function next() {
+		while(index < benchmarks.length && filter && benchmarks[index].name.indexOf(filter) < 0 && name.indexOf(filter) < 0)
+			++index;
+
+		if(index === benchmarks.length)
+			return cb();
+
+		var benchmark = benchmarks[index++];
+		if(benchmark.fn.length < 2) {
+			var start = process.hrtime();
+			for(var i = 0; i < benchmark.ops; ++i)
+				benchmark.fn(i);
+
+			report(benchmark.name, benchmark.ops, elapsedNs(start));
+			setImmediate(next);
+		}
+		else {
+			runAsync(benchmark, function(err) {
+				if(err)
+					return cb(err);
+
+				next();
+			});
+		}
+	}
+
+	next();
+}
+
+function runAsync(benchmark, cb) {
+	var concurrency = benchmark.concurrency || 1;
+	var issued = 0;
+	var completed = 0;
+	var failed = false;
+	var start = process.hrtime();
+
+	function issue() {
+		var i = issued++;
+		benchmark.fn(i, function(err) {
+			if(failed)
+				return;
+			if(err) {
+				failed = true;
+				return cb(err);
+			}
+
+			if(++completed === benchmark.ops) {
+				report(benchmark.name, benchmark.ops, elapsedNs(start));
+				cb();
+			}
+			else if(issued < benchmark.ops)
+				issue();
+		});
+	}
+
+	for(var i = 0; i < concurrency && i < benchmark.ops; ++i)
+		issue();
+}
+
+module.exports = {
+	runSuite: runSuite
+};
@@ -0,0 +1,673 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * An in-memory stand-in for libfdb_c, for benchmarking the binding on machines
+ * without a cluster. Keys live in one ordered map. Futures are completed on the
+ * thread running fdb_run_network, after the latency in FDB_FAKE_LATENCY_US
+ * (microseconds, default 0), so callbacks arrive from another thread just as they
+ * do with the real client.
+ *
+ * Reads see the committed data as of the time of the read, not the transaction's
+ * own writes, and commits never conflict. Watches fire on the first commit that
+ * writes their key. None of this is meant to be correct enough for anything but
+ * measuring the overhead of the binding.
+ */
+
+#define FDB_API_VERSION 300
+
+#include <foundationdb/fdb_c.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct FDBCluster { };
+struct FDBDatabase { };
+
+struct FDBFuture {
+	FDBFuture() : refCount(1), ready(false), error(0), callback(NULL), callbackParameter(NULL),
+		version(0), present(false), more(false), cluster(NULL), database(NULL) { }
+
+	int refCount;
+	bool ready;
+	fdb_error_t error;
+	FDBCallback callback;
+	void *callbackParameter;
+
+	int64_t version;
+	bool present;
+	string value;
+	vector<string> rowData;
+	vector<FDBKeyValue> rows;
+	bool more;
+	vector<string> strings;
+	vector<const char*> stringPointers;
+	FDBCluster *cluster;
+	FDBDatabase *database;
+};
+
+struct Mutation {
+	enum Type { SET, CLEAR, CLEAR_RANGE, ATOMIC };
+
+	Type type;
+	string param1;
+	string param2;
+	FDBMutationType atomicType;
+};
+
+struct FDBTransaction {
+	FDBTransaction() : readVersion(0), committedVersion(-1) { }
+
+	int64_t readVersion;
+	int64_t committedVersion;
+	vector<Mutation> mutations;
+};
+
+typedef map<string, string> KeyValueMap;
+
+static mutex storeMutex;
+static KeyValueMap store;
+static int64_t storeVersion = 1;
+static multimap<string, FDBFuture*> watches;
+
+static mutex futureMutex;
+static condition_variable futureReady;
+
+static mutex networkMutex;
+static condition_variable networkWake;
+static multimap<Clock::time_point, FDBFuture*> scheduled;
+static bool networkStopped = false;
+static chrono::microseconds latency(0);
+
+static void release(FDBFuture *f) {
+	bool destroy;
+	{
+		lock_guard<mutex> lock(futureMutex);
+		destroy = --f->refCount == 0;
+	}
+
+	if(destroy)
+		delete f;
+}
+
+static void complete(FDBFuture *f, fdb_error_t error) {
+	FDBCallback callback = NULL;
+	void *parameter = NULL;
+
+	{
+		lock_guard<mutex> lock(futureMutex);
+		if(f->ready)
+			return;
+
+		f->ready = true;
+		f->error = error;
+		callback = f->callback;
+		parameter = f->callbackParameter;
+		f->callback = NULL;
+	}
+
+	futureReady.notify_all();
+	if(callback)
+		callback(f, parameter);
+}
+
+// Completes the future on the network thread once the configured latency has passed
+static FDBFuture* schedule(FDBFuture *f, fdb_error_t error = 0) {
+	f->error = error;
+	++f->refCount;
+
+	{
+		lock_guard<mutex> lock(networkMutex);
+		scheduled.insert(make_pair(Clock::now() + latency, f));
+	}
+
+	networkWake.notify_one();
+	return f;
+}
+
+static string toString(uint8_t const *data, int length) {
+	return string((const char*)data, length);
+}
+
+extern "C" {
+
+const char* fdb_get_error(fdb_error_t code) {
+	switch(code) {
+		case 0: return "Success";
+		case 1007: return "Transaction is too old to perform reads or be committed";
+		case 1009: return "Request for future version";
+		case 1020: return "Transaction not committed due to conflict with another transaction";
+		case 1021: return "Transaction may or may not have committed";
+		case 1101: return "Asynchronous operation cancelled";
+		case 2203: return "API version not supported by the installed FoundationDB C library";
+		default: return "Unknown error";
+	}
+}
+
+fdb_error_t fdb_select_api_version_impl(int runtime_version, int header_version) {
+	if(runtime_version > FDB_API_VERSION || header_version > FDB_API_VERSION)
+		return 2203;
+
+	return 0;
+}
+
+int fdb_get_max_api_version() {
+	return FDB_API_VERSION;
+}
+
+fdb_error_t fdb_network_set_option(FDBNetworkOption option, uint8_t const *value, int value_length) {
+	return 0;
+}
+
+fdb_error_t fdb_setup_network() {
+	const char *latencyVar = getenv("FDB_FAKE_LATENCY_US");
+	if(latencyVar)
+		latency = chrono::microseconds(atol(latencyVar));
+
+	return 0;
+}
+
+fdb_error_t fdb_run_network() {
+	unique_lock<mutex> lock(networkMutex);
+	while(!networkStopped) {
+		if(scheduled.empty()) {
+			networkWake.wait(lock);
+			continue;
+		}
+
+		multimap<Clock::time_point, FDBFuture*>::iterator next = scheduled.begin();
+		if(next->first > Clock::now()) {
+			networkWake.wait_until(lock, next->first);
+			continue;
+		}
+
+		FDBFuture *f = next->second;
+		scheduled.erase(next);
+
+		lock.unlock();
+		complete(f, f->error);
+		release(f);
+		lock.lock();
+	}
+
+	return 0;
+}
+
+fdb_error_t fdb_stop_network() {
+	{
+		lock_guard<mutex> lock(networkMutex);
+		networkStopped = true;
+	}
+
+	networkWake.notify_one();
+	return 0;
+}
+
+void fdb_future_cancel(FDBFuture *f) {
+	complete(f, 1101);
+}
+
+void fdb_future_release_memory(FDBFuture *f) { }
+
+void fdb_future_destroy(FDBFuture *f) {
+	{
+		lock_guard<mutex> lock(futureMutex);
+		f->ready = true;
+		f->callback = NULL;
+	}
+
+	release(f);
+}
+
+fdb_error_t fdb_future_block_until_ready(FDBFuture *f) {
+	unique_lock<mutex> lock(futureMutex);
+	while(!f->ready)
+		futureReady.wait(lock);
+
+	return 0;
+}
+
+fdb_bool_t fdb_future_is_ready(FDBFuture *f) {
+	lock_guard<mutex> lock(futureMutex);
+	return f->ready;
+}
+
+fdb_error_t fdb_future_set_callback(FDBFuture *f, FDBCallback callback, void *callback_parameter) {
+	{
+		lock_guard<mutex> lock(futureMutex);
+		if(!f->ready) {
+			f->callback = callback;
+			f->callbackParameter = callback_parameter;
+			return 0;
+		}
+	}
+
+	callback(f, callback_parameter);
+	return 0;
+}
+
+fdb_error_t fdb_future_get_error(FDBFuture *f) {
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_version(FDBFuture *f, int64_t *out_version) {
+	*out_version = f->version;
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_key(FDBFuture *f, uint8_t const **out_key, int *out_key_length) {
+	*out_key = (uint8_t const*)f->value.data();
+	*out_key_length = (int)f->value.size();
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_cluster(FDBFuture *f, FDBCluster **out_cluster) {
+	*out_cluster = f->cluster;
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_database(FDBFuture *f, FDBDatabase **out_database) {
+	*out_database = f->database;
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_value(FDBFuture *f, fdb_bool_t *out_present, uint8_t const **out_value, int *out_value_length) {
+	*out_present = f->present;
+	*out_value = (uint8_t const*)f->value.data();
+	*out_value_length = (int)f->value.size();
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_keyvalue_array(FDBFuture *f, FDBKeyValue const **out_kv, int *out_count, fdb_bool_t *out_more) {
+	*out_kv = f->rows.empty() ? NULL : &f->rows[0];
+	*out_count = (int)f->rows.size();
+	*out_more = f->more;
+	return f->error;
+}
+
+fdb_error_t fdb_future_get_string_array(FDBFuture *f, const char ***out_strings, int *out_count) {
+	*out_strings = f->stringPointers.empty() ? NULL : &f->stringPointers[0];
+	*out_count = (int)f->stringPointers.size();
+	return f->error;
+}
+
+FDBFuture* fdb_create_cluster(const char *cluster_file_path) {
+	FDBFuture *f = new FDBFuture();
+	f->cluster = new FDBCluster();
+	return schedule(f);
+}
+
+void fdb_cluster_destroy(FDBCluster *c) {
+	delete c;
+}
+
+fdb_error_t fdb_cluster_set_option(FDBCluster *c, FDBClusterOption option, uint8_t const *value, int value_length) {
+	return 0;
+}
+
+FDBFuture* fdb_cluster_create_database(FDBCluster *c, uint8_t const *db_name, int db_name_length) {
+	FDBFuture *f = new FDBFuture();
+	f->database = new FDBDatabase();
+	return schedule(f);
+}
+
+void fdb_database_destroy(FDBDatabase *d) {
+	delete d;
+}
+
+fdb_error_t fdb_database_set_option(FDBDatabase *d, FDBDatabaseOption option, uint8_t const *value, int value_length) {
+	return 0;
+}
+
+fdb_error_t fdb_database_create_transaction(FDBDatabase *d, FDBTransaction **out_transaction) {
+	*out_transaction = new FDBTransaction();
+	return 0;
+}
+
+void fdb_transaction_destroy(FDBTransaction *tr) {
+	delete tr;
+}
+
+void fdb_transaction_cancel(FDBTransaction *tr) { }
+
+fdb_error_t fdb_transaction_set_option(FDBTransaction *tr, FDBTransactionOption option, uint8_t const *value, int value_length) {
+	return 0;
+}
+
+void fdb_transaction_set_read_version(FDBTransaction *tr, int64_t version) {
+	tr->readVersion = version;
+}
+
+FDBFuture* fdb_transaction_get_read_version(FDBTransaction *tr) {
+	if(!tr->readVersion) {
+		lock_guard<mutex> lock(storeMutex);
+		tr->readVersion = storeVersion;
+	}
+
+	FDBFuture *f = new FDBFuture();
+	f->version = tr->readVersion;
+	return schedule(f);
+}
+
+FDBFuture* fdb_transaction_get(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, fdb_bool_t snapshot) {
+	FDBFuture *f = new FDBFuture();
+
+	{
+		lock_guard<mutex> lock(storeMutex);
+		KeyValueMap::iterator it = store.find(toString(key_name, key_name_length));
+		if(it != store.end()) {
+			f->present = true;
+			f->value = it->second;
+		}
+	}
+
+	return schedule(f);
+}
+
+/*
+ * Finds the position a key selector refers to: the last key less than (or equal to,
+ * with orEqual) key, moved forward by offset. Positions before the first key resolve
+ * to the beginning of the map, and positions after the last key to its end.
+ */
+static KeyValueMap::iterator resolveSelector(const string &key, fdb_bool_t orEqual, int offset, bool &beforeBegin) {
+	KeyValueMap::iterator it = orEqual ? store.upper_bound(key) : store.lower_bound(key);
+	beforeBegin = false;
+
+	for(int step = offset - 1; step > 0 && it != store.end(); --step)
+		++it;
+
+	for(int step = offset - 1; step < 0; ++step) {
+		if(it == store.begin()) {
+			beforeBegin = true;
+			break;
+		}
+
+		--it;
+	}
+
+	return it;
+}
+
+FDBFuture* fdb_transaction_get_key(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, fdb_bool_t or_equal, int offset, fdb_bool_t snapshot) {
+	FDBFuture *f = new FDBFuture();
+
+	{
+		lock_guard<mutex> lock(storeMutex);
+		bool beforeBegin;
+		KeyValueMap::iterator it = resolveSelector(toString(key_name, key_name_length), or_equal, offset, beforeBegin);
+		if(beforeBegin)
+			f->value = "";
+		else if(it == store.end())
+			f->value = "\xff";
+		else
+			f->value = it->first;
+	}
+
+	return schedule(f);
+}
+
+FDBFuture* fdb_transaction_get_addresses_for_key(FDBTransaction *tr, uint8_t const *key_name, int key_name_length) {
+	FDBFuture *f = new FDBFuture();
+	f->strings.push_back("127.0.0.1:4500");
+	f->stringPointers.push_back(f->strings[0].c_str());
+	return schedule(f);
+}
+
+// The number of rows returned per request, standing in for the byte limits of the real client
+static size_t batchRows(FDBStreamingMode mode, int iteration) {
+	switch(mode) {
+		case FDB_STREAMING_MODE_ITERATOR:
+			return (size_t)16 << (iteration < 1 ? 0 : (iteration > 11 ? 10 : iteration - 1));
+		case FDB_STREAMING_MODE_SMALL:
+			return 64;
+		case FDB_STREAMING_MODE_MEDIUM:
+			return 512;
+		case FDB_STREAMING_MODE_LARGE:
+		case FDB_STREAMING_MODE_SERIAL:
+			return 4096;
+		default:
+			return (size_t)-1;
+	}
+}
+
+FDBFuture* fdb_transaction_get_range(FDBTransaction *tr,
+	uint8_t const *begin_key_name, int begin_key_name_length, fdb_bool_t begin_or_equal, int begin_offset,
+	uint8_t const *end_key_name, int end_key_name_length, fdb_bool_t end_or_equal, int end_offset,
+	int limit, int target_bytes, FDBStreamingMode mode, int iteration, fdb_bool_t snapshot, fdb_bool_t reverse)
+{
+	FDBFuture *f = new FDBFuture();
+
+	{
+		lock_guard<mutex> lock(storeMutex);
+
+		bool beginBeforeBegin, endBeforeBegin;
+		KeyValueMap::iterator begin = resolveSelector(toString(begin_key_name, begin_key_name_length), begin_or_equal, begin_offset, beginBeforeBegin);
+		KeyValueMap::iterator end = resolveSelector(toString(end_key_name, end_key_name_length), end_or_equal, end_offset, endBeforeBegin);
+
+		vector<KeyValueMap::iterator> selected;
+		if(!endBeforeBegin && begin != store.end() && (end == store.end() || begin->first < end->first)) {
+			size_t maxRows = batchRows(mode, iteration);
+			if(limit > 0 && (size_t)limit < maxRows)
+				maxRows = limit;
+
+			if(!reverse) {
+				for(KeyValueMap::iterator it = begin; it != end; ++it) {
+					if(selected.size() == maxRows) {
+						f->more = true;
+						break;
+					}
+
+					selected.push_back(it);
+				}
+			}
+			else {
+				for(KeyValueMap::iterator it = end; it != begin;) {
+					if(selected.size() == maxRows) {
+						f->more = true;
+						break;
+					}
+
+					selected.push_back(--it);
+				}
+			}
+		}
+
+		f->rowData.reserve(selected.size() * 2);
+		f->rows.resize(selected.size());
+		for(size_t i = 0; i < selected.size(); i++) {
+			f->rowData.push_back(selected[i]->first);
+			f->rowData.push_back(selected[i]->second);
+		}
+
+		for(size_t i = 0; i < selected.size(); i++) {
+			f->rows[i].key = f->rowData[2 * i].data();
+			f->rows[i].key_length = (int)f->rowData[2 * i].size();
+			f->rows[i].value = f->rowData[2 * i + 1].data();
+			f->rows[i].value_length = (int)f->rowData[2 * i + 1].size();
+		}
+	}
+
+	return schedule(f);
+}
+
+void fdb_transaction_set(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, uint8_t const *value, int value_length) {
+	Mutation m = { Mutation::SET, toString(key_name, key_name_length), toString(value, value_length), 0 };
+	tr->mutations.push_back(m);
+}
+
+void fdb_transaction_atomic_op(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, uint8_t const *param, int param_length, FDBMutationType operation_type) {
+	Mutation m = { Mutation::ATOMIC, toString(key_name, key_name_length), toString(param, param_length), operation_type };
+	tr->mutations.push_back(m);
+}
+
+void fdb_transaction_clear(FDBTransaction *tr, uint8_t const *key_name, int key_name_length) {
+	Mutation m = { Mutation::CLEAR, toString(key_name, key_name_length), string(), 0 };
+	tr->mutations.push_back(m);
+}
+
+void fdb_transaction_clear_range(FDBTransaction *tr, uint8_t const *begin_key_name, int begin_key_name_length, uint8_t const *end_key_name, int end_key_name_length) {
+	Mutation m = { Mutation::CLEAR_RANGE, toString(begin_key_name, begin_key_name_length), toString(end_key_name, end_key_name_length), 0 };
+	tr->mutations.push_back(m);
+}
+
+FDBFuture* fdb_transaction_watch(FDBTransaction *tr, uint8_t const *key_name, int key_name_length) {
+	FDBFuture *f = new FDBFuture();
+	++f->refCount;
+
+	lock_guard<mutex> lock(storeMutex);
+	watches.insert(make_pair(toString(key_name, key_name_length), f));
+	return f;
+}
+
+// Little-endian add, bitwise and/or/xor and unsigned max/min, as in the real client
+static string applyAtomic(FDBMutationType type, const string &existing, const string &param) {
+	string result = param;
+	string current = existing;
+	current.resize(param.size(), '\0');
+
+	switch(type) {
+		case 2: {
+			int carry = 0;
+			for(size_t i = 0; i < param.size(); i++) {
+				int sum = (uint8_t)current[i] + (uint8_t)param[i] + carry;
+				result[i] = (char)(sum & 0xff);
+				carry = sum >> 8;
+			}
+			break;
+		}
+		case 6:
+			for(size_t i = 0; i < param.size(); i++)
+				result[i] = current[i] & param[i];
+			break;
+		case 7:
+			for(size_t i = 0; i < param.size(); i++)
+				result[i] = current[i] | param[i];
+			break;
+		case 8:
+			for(size_t i = 0; i < param.size(); i++)
+				result[i] = current[i] ^ param[i];
+			break;
+		case 12:
+		case 13: {
+			int cmp = 0;
+			for(size_t i = param.size(); i > 0 && cmp == 0; i--)
+				cmp = (int)(uint8_t)current[i - 1] - (int)(uint8_t)param[i - 1];
+
+			if((type == 12) == (cmp > 0))
+				result = current;
+			break;
+		}
+	}
+
+	return result;
+}
+
+static void triggerWatches(const string &begin, const string *end, vector<FDBFuture*> &triggered) {
+	multimap<string, FDBFuture*>::iterator it = watches.lower_bound(begin);
+	while(it != watches.end() && (end ? it->first < *end : it->first == begin)) {
+		triggered.push_back(it->second);
+		watches.erase(it++);
+	}
+}
+
+FDBFuture* fdb_transaction_commit(FDBTransaction *tr) {
+	vector<FDBFuture*> triggered;
+
+	{
+		lock_guard<mutex> lock(storeMutex);
+		for(size_t i = 0; i < tr->mutations.size(); i++) {
+			Mutation &m = tr->mutations[i];
+			switch(m.type) {
+				case Mutation::SET:
+					store[m.param1] = m.param2;
+					triggerWatches(m.param1, NULL, triggered);
+					break;
+				case Mutation::CLEAR:
+					store.erase(m.param1);
+					triggerWatches(m.param1, NULL, triggered);
+					break;
+				case Mutation::CLEAR_RANGE:
+					store.erase(store.lower_bound(m.param1), store.lower_bound(m.param2));
+					triggerWatches(m.param1, &m.param2, triggered);
+					break;
+				case Mutation::ATOMIC: {
+					KeyValueMap::iterator it = store.find(m.param1);
+					store[m.param1] = applyAtomic(m.atomicType, it == store.end() ? string() : it->second, m.param2);
+					triggerWatches(m.param1, NULL, triggered);
+					break;
+				}
+			}
+		}
+
+		if(!tr->mutations.empty())
+			++storeVersion;
+
+		tr->committedVersion = tr->mutations.empty() ? -1 : storeVersion;
+		tr->mutations.clear();
+	}
+
+	for(size_t i = 0; i < triggered.size(); i++) {
+		schedule(triggered[i]);
+		release(triggered[i]);
+	}
+
+	return schedule(new FDBFuture());
+}
+
+fdb_error_t fdb_transaction_get_committed_version(FDBTransaction *tr, int64_t *out_version) {
+	*out_version = tr->committedVersion;
+	return 0;
+}
+
+void fdb_transaction_reset(FDBTransaction *tr) {
+	tr->readVersion = 0;
+	tr->committedVersion = -1;
+	tr->mutations.clear();
+}
+
+FDBFuture* fdb_transaction_on_error(FDBTransaction *tr, fdb_error_t error) {
+	bool retryable = error == 1007 || error == 1009 || error == 1020 || error == 1021;
+	if(retryable)
+		fdb_transaction_reset(tr);
+
+	return schedule(new FDBFuture(), retryable ? 0 : error);
+}
+
+fdb_error_t fdb_transaction_add_conflict_range(FDBTransaction *tr, uint8_t const *begin_key_name, int begin_key_name_length,
+	uint8_t const *end_key_name, int end_key_name_length, FDBConflictRangeType type)
+{
+	return 0;
+}
+
+}
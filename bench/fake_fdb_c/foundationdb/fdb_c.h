@@ -0,0 +1,146 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The subset of the FoundationDB C API (version 300) used by the binding, implemented
+ * in memory by fake_fdb_c.cpp. Only for benchmarking the binding without a cluster.
+ */
+
+#ifndef FDB_NODE_FAKE_FDB_C_H
+#define FDB_NODE_FAKE_FDB_C_H
+
+#include <stdint.h>
+
+#ifndef FDB_API_VERSION
+#error You must #define FDB_API_VERSION prior to including fdb_c.h
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FDBFuture FDBFuture;
+typedef struct FDBCluster FDBCluster;
+typedef struct FDBDatabase FDBDatabase;
+typedef struct FDBTransaction FDBTransaction;
+
+typedef int fdb_error_t;
+typedef int fdb_bool_t;
+
+typedef int FDBNetworkOption;
+typedef int FDBClusterOption;
+typedef int FDBDatabaseOption;
+typedef int FDBTransactionOption;
+typedef int FDBMutationType;
+
+typedef enum {
+	FDB_STREAMING_MODE_WANT_ALL = -2,
+	FDB_STREAMING_MODE_ITERATOR = -1,
+	FDB_STREAMING_MODE_EXACT = 0,
+	FDB_STREAMING_MODE_SMALL = 1,
+	FDB_STREAMING_MODE_MEDIUM = 2,
+	FDB_STREAMING_MODE_LARGE = 3,
+	FDB_STREAMING_MODE_SERIAL = 4
+} FDBStreamingMode;
+
+typedef enum {
+	FDB_CONFLICT_RANGE_TYPE_READ = 0,
+	FDB_CONFLICT_RANGE_TYPE_WRITE = 1
+} FDBConflictRangeType;
+
+#pragma pack(push, 4)
+typedef struct keyvalue {
+	const void *key;
+	int key_length;
+	const void *value;
+	int value_length;
+} FDBKeyValue;
+#pragma pack(pop)
+
+typedef void (*FDBCallback)(FDBFuture *future, void *callback_parameter);
+
+const char* fdb_get_error(fdb_error_t code);
+
+fdb_error_t fdb_select_api_version_impl(int runtime_version, int header_version);
+int fdb_get_max_api_version();
+
+#define fdb_select_api_version(v) fdb_select_api_version_impl(v, FDB_API_VERSION)
+
+fdb_error_t fdb_network_set_option(FDBNetworkOption option, uint8_t const *value, int value_length);
+fdb_error_t fdb_setup_network();
+fdb_error_t fdb_run_network();
+fdb_error_t fdb_stop_network();
+
+void fdb_future_cancel(FDBFuture *f);
+void fdb_future_release_memory(FDBFuture *f);
+void fdb_future_destroy(FDBFuture *f);
+fdb_error_t fdb_future_block_until_ready(FDBFuture *f);
+fdb_bool_t fdb_future_is_ready(FDBFuture *f);
+fdb_error_t fdb_future_set_callback(FDBFuture *f, FDBCallback callback, void *callback_parameter);
+fdb_error_t fdb_future_get_error(FDBFuture *f);
+fdb_error_t fdb_future_get_version(FDBFuture *f, int64_t *out_version);
+fdb_error_t fdb_future_get_key(FDBFuture *f, uint8_t const **out_key, int *out_key_length);
+fdb_error_t fdb_future_get_cluster(FDBFuture *f, FDBCluster **out_cluster);
+fdb_error_t fdb_future_get_database(FDBFuture *f, FDBDatabase **out_database);
+fdb_error_t fdb_future_get_value(FDBFuture *f, fdb_bool_t *out_present, uint8_t const **out_value, int *out_value_length);
+fdb_error_t fdb_future_get_keyvalue_array(FDBFuture *f, FDBKeyValue const **out_kv, int *out_count, fdb_bool_t *out_more);
+fdb_error_t fdb_future_get_string_array(FDBFuture *f, const char ***out_strings, int *out_count);
+
+FDBFuture* fdb_create_cluster(const char *cluster_file_path);
+void fdb_cluster_destroy(FDBCluster *c);
+fdb_error_t fdb_cluster_set_option(FDBCluster *c, FDBClusterOption option, uint8_t const *value, int value_length);
+FDBFuture* fdb_cluster_create_database(FDBCluster *c, uint8_t const *db_name, int db_name_length);
+
+void fdb_database_destroy(FDBDatabase *d);
+fdb_error_t fdb_database_set_option(FDBDatabase *d, FDBDatabaseOption option, uint8_t const *value, int value_length);
+fdb_error_t fdb_database_create_transaction(FDBDatabase *d, FDBTransaction **out_transaction);
+
+void fdb_transaction_destroy(FDBTransaction *tr);
+void fdb_transaction_cancel(FDBTransaction *tr);
+fdb_error_t fdb_transaction_set_option(FDBTransaction *tr, FDBTransactionOption option, uint8_t const *value, int value_length);
+void fdb_transaction_set_read_version(FDBTransaction *tr, int64_t version);
+FDBFuture* fdb_transaction_get_read_version(FDBTransaction *tr);
+FDBFuture* fdb_transaction_get(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, fdb_bool_t snapshot);
+FDBFuture* fdb_transaction_get_key(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, fdb_bool_t or_equal, int offset, fdb_bool_t snapshot);
+FDBFuture* fdb_transaction_get_addresses_for_key(FDBTransaction *tr, uint8_t const *key_name, int key_name_length);
+FDBFuture* fdb_transaction_get_range(FDBTransaction *tr,
+	uint8_t const *begin_key_name, int begin_key_name_length, fdb_bool_t begin_or_equal, int begin_offset,
+	uint8_t const *end_key_name, int end_key_name_length, fdb_bool_t end_or_equal, int end_offset,
+	int limit, int target_bytes, FDBStreamingMode mode, int iteration, fdb_bool_t snapshot, fdb_bool_t reverse);
+void fdb_transaction_set(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, uint8_t const *value, int value_length);
+void fdb_transaction_atomic_op(FDBTransaction *tr, uint8_t const *key_name, int key_name_length, uint8_t const *param, int param_length, FDBMutationType operation_type);
+void fdb_transaction_clear(FDBTransaction *tr, uint8_t const *key_name, int key_name_length);
+void fdb_transaction_clear_range(FDBTransaction *tr, uint8_t const *begin_key_name, int begin_key_name_length, uint8_t const *end_key_name, int end_key_name_length);
+FDBFuture* fdb_transaction_watch(FDBTransaction *tr, uint8_t const *key_name, int key_name_length);
+FDBFuture* fdb_transaction_commit(FDBTransaction *tr);
+fdb_error_t fdb_transaction_get_committed_version(FDBTransaction *tr, int64_t *out_version);
+FDBFuture* fdb_transaction_on_error(FDBTransaction *tr, fdb_error_t error);
+void fdb_transaction_reset(FDBTransaction *tr);
+fdb_error_t fdb_transaction_add_conflict_range(FDBTransaction *tr, uint8_t const *begin_key_name, int begin_key_name_length,
+	uint8_t const *end_key_name, int end_key_name_length, FDBConflictRangeType type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
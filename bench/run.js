@@ -0,0 +1,71 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Microbenchmarks of the binding. They are meant to be run against the in-memory
+ * stand-in for libfdb_c, which needs no cluster:
+ *
+ *   node-gyp rebuild -- -Dfdb_c_fake=1
+ *   FDB_FAKE_LATENCY_US=0 node bench/run.js [filter]
+ *
+ * FDB_FAKE_LATENCY_US delays the completion of every future, which is useful for
+ * seeing how the binding behaves with many requests outstanding. Only benchmarks
+ * (or suites) whose name contains filter are run. Against a real cluster, the
+ * transaction benchmarks write to keys starting with 'bench/'.
+ */
+
+"use strict";
+
+var fdb = require('../lib/fdb').apiVersion(300);
+var common = require('./common');
+
+var filter = process.argv[2];
+var db = fdb.open();
+
+var transaction = require('./transaction')(fdb, db);
+
+var suites = [
+	['tuple', require('./tuple')(fdb)],
+	['subspace', require('./subspace')(fdb)],
+	['transaction', transaction.benchmarks]
+];
+
+transaction.seed(function(err) {
+	if(err)
+		throw err;
+
+	var index = 0;
+	(function next(err) {
+		if(err)
+			throw err;
+
+		if(index < suites.length) {
+			var suite = suites[index++];
+			common.runSuite(suite[0], suite[1], filter, next);
+		}
+		else {
+			console.log(JSON.stringify(fdb.stats().operations.get.latency));
+			process.exit(0);
+		}
+	})();
+});
@@ -0,0 +1,40 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+module.exports = function(fdb) {
+	var subspace = new fdb.Subspace(['app', 'index']);
+	var key = subspace.pack(['by_name', 'alice', 42]);
+	var outside = new Buffer('elsewhere');
+	var builder = subspace.keyBuilder();
+
+	return [
+		{ name: 'pack', ops: 200000, fn: function(i) { subspace.pack(['by_name', 'alice', i]); } },
+		{ name: 'keyBuilder pack', ops: 200000, fn: function(i) { builder.pack(['by_name', 'alice', i]); } },
+		{ name: 'unpack', ops: 200000, fn: function() { subspace.unpack(key); } },
+		{ name: 'contains', ops: 500000, fn: function(i) { subspace.contains(i & 1 ? key : outside); } },
+		{ name: 'range', ops: 200000, fn: function() { subspace.range(['by_name']); } },
+		{ name: 'subspace', ops: 200000, fn: function(i) { subspace.subspace(['by_name', i]); } }
+	];
+};
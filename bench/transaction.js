@@ -0,0 +1,84 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var ROWS = 10000;
+
+function rowKey(i) {
+	return new Buffer('bench/row/' + (100000 + i));
+}
+
+// Writes the rows the range benchmarks read
+function seed(db, cb) {
+	db.doTransaction(function(tr, innerCb) {
+		var value = new Buffer(100);
+		value.fill(120);
+		for(var i = 0; i < ROWS; ++i)
+			tr.set(rowKey(i), value);
+
+		innerCb();
+	}, cb);
+}
+
+module.exports = function(fdb, db) {
+	var begin = new Buffer('bench/row/');
+	var end = new Buffer('bench/row0');
+	var key = rowKey(500);
+	var sharedTr = db.createTransaction();
+
+	return { seed: seed.bind(null, db), benchmarks: [
+		{ name: 'tr.get', ops: 50000, concurrency: 100, fn: function(i, cb) { sharedTr.get(key, cb); } },
+		{ name: 'tr.getMany (10 keys)', ops: 10000, concurrency: 100, fn: function(i, cb) {
+			sharedTr.getMany([rowKey(0), rowKey(1), rowKey(2), rowKey(3), rowKey(4), rowKey(5), rowKey(6), rowKey(7), rowKey(8), rowKey(9)], cb);
+		} },
+		{ name: 'db.get', ops: 20000, concurrency: 100, fn: function(i, cb) { db.get(key, cb); } },
+		{ name: 'getRange 1k rows toArray', ops: 200, fn: function(i, cb) {
+			sharedTr.getRange(begin, end, { limit: 1000 }).toArray(cb);
+		} },
+		{ name: 'getRange 10k rows toArray', ops: 20, fn: function(i, cb) {
+			sharedTr.getRange(begin, end).toArray(cb);
+		} },
+		{ name: 'getRange 10k rows forEachBatch', ops: 20, fn: function(i, cb) {
+			sharedTr.getRange(begin, end).forEachBatch(function(kvs, loopCb) { loopCb(); }, cb);
+		} },
+		{ name: 'getRange 10k rows packed', ops: 20, fn: function(i, cb) {
+			sharedTr.getRange(begin, end, { packed: true }).forEachBatch(function(kvs, loopCb) { loopCb(); }, cb);
+		} },
+		{ name: 'doTransaction read-only', ops: 20000, concurrency: 100, fn: function(i, cb) {
+			db.doTransaction(function(tr, innerCb) { tr.get(key, innerCb); }, cb);
+		} },
+		{ name: 'doTransaction set', ops: 20000, concurrency: 100, fn: function(i, cb) {
+			db.doTransaction(function(tr, innerCb) { tr.set(key, key); innerCb(); }, cb);
+		} },
+		{ name: 'doTransaction with one retry', ops: 10000, concurrency: 100, fn: function(i, cb) {
+			var attempt = 0;
+			db.doTransaction(function(tr, innerCb) {
+				if(attempt++ === 0)
+					innerCb(new fdb.FDBError('not_committed', 1020));
+				else
+					innerCb();
+			}, cb);
+		} }
+	] };
+};
@@ -0,0 +1,45 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+module.exports = function(fdb) {
+	var tuple = fdb.tuple;
+
+	var small = ['users', 12345, 'email'];
+	var mixed = ['events', 1420070400000, -17, new Buffer('payload'), null, 'a string with \u00e9 unicode'];
+	var smallPacked = tuple.pack(small);
+	var mixedPacked = tuple.pack(mixed);
+	var codec = tuple.compile([{ name: 'table', type: 'string' }, { name: 'id', type: 'int' }, { name: 'field', type: 'string' }]);
+	var fields = { table: 'users', id: 12345, field: 'email' };
+
+	return [
+		{ name: 'pack small', ops: 200000, fn: function() { tuple.pack(small); } },
+		{ name: 'pack mixed', ops: 100000, fn: function() { tuple.pack(mixed); } },
+		{ name: 'unpack small', ops: 200000, fn: function() { tuple.unpack(smallPacked); } },
+		{ name: 'unpack mixed', ops: 100000, fn: function() { tuple.unpack(mixedPacked); } },
+		{ name: 'compiled pack small', ops: 200000, fn: function() { codec.pack(fields); } },
+		{ name: 'compiled unpack small', ops: 200000, fn: function() { codec.unpack(smallPacked); } },
+		{ name: 'range', ops: 100000, fn: function() { tuple.range(small); } }
+	];
+};
@@ -1,18 +1,30 @@
 {
+  'variables': {
+    # Set to 1 (node-gyp rebuild -- -Dfdb_c_fake=1) to link against the in-memory stand-in for libfdb_c in bench/fake_fdb_c
+    'fdb_c_fake%': 0,
+  },
   'targets': [
     {
       'target_name': 'fdblib',
-      'sources': [ 'src/FdbV8Wrapper.cpp', 'src/Database.cpp', 'src/Transaction.cpp', 'src/Cluster.cpp', 'src/FdbError.cpp', 'src/FdbOptions.cpp', 'src/FdbOptions.g.cpp' ],
+      'sources': [ 'src/FdbV8Wrapper.cpp', 'src/NodeCallback.cpp', 'src/Database.cpp', 'src/Transaction.cpp', 'src/Cluster.cpp', 'src/FdbError.cpp', 'src/FdbOptions.cpp', 'src/FdbOptions.g.cpp', 'src/Tuple.cpp', 'src/V8Cache.cpp', 'src/Stats.cpp' ],
       'conditions': [
-        ['OS=="linux"', {
+        ['fdb_c_fake==1', {
+          'sources': [ 'bench/fake_fdb_c/fake_fdb_c.cpp' ],
+          'include_dirs': [ 'bench/fake_fdb_c' ],
+        }],
+        ['OS=="linux" and fdb_c_fake==0', {
           'link_settings': { 'libraries': ['-lfdb_c'] },
         }],
         ['OS=="mac"', {
           'xcode_settings': { 'OTHER_CFLAGS': ['-std=c++0x'] },
-          'include_dirs': ['/usr/local/include'],
-          'link_settings': { 'libraries': ['-lfdb_c', '-L/usr/local/lib'] },
+          'conditions': [
+            ['fdb_c_fake==0', {
+              'include_dirs': ['/usr/local/include'],
+              'link_settings': { 'libraries': ['-lfdb_c', '-L/usr/local/lib'] },
+            }],
+          ],
         }],
-        ['OS=="win"', {
+        ['OS=="win" and fdb_c_fake==0', {
           'link_settings': { 'libraries': ['<!(echo %FOUNDATIONDB_INSTALL_PATH%)\\lib\\foundationdb\\fdb_c.lib'] },
           'include_dirs': ['<!(echo %FOUNDATIONDB_INSTALL_PATH%)\\include'],
         }],
@@ -32,8 +32,14 @@ var toBuffer = function(obj) {
 
 	if(obj instanceof Uint8Array) {
 		var buf = new Buffer(obj.length);
-		for(var i = 0; i < obj.length; ++i)
-			buf[i] = obj[i];
+
+		// Where Buffers are themselves Uint8Arrays, set copies natively
+		if(buf instanceof Uint8Array)
+			buf.set(obj);
+		else {
+			for(var i = 0; i < obj.length; ++i)
+				buf[i] = obj[i];
+		}
 
 		return buf;
 	}
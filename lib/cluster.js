@@ -27,13 +27,27 @@ var future = require('./future');
 var Database = require('./database');
 var apiVersion = require('./apiVersion');
 
-var openDatabase = function(dbName) {
+var openDatabaseAsync = function(cluster, dbName, cb) {
+	return future.create(function(futureCb) {
+		cluster._cluster.openDatabase(dbName, function(err, database) {
+			if(err)
+				futureCb(err);
+			else
+				futureCb(undefined, new Database(database));
+		});
+	}, cb);
+};
+
+// Without a callback, this blocks until the database is open
+var openDatabase = function(dbName, cb) {
+	if(cb)
+		return openDatabaseAsync(this, dbName, cb);
+
 	return new Database(this._cluster.openDatabase(dbName));
 };
 
 var openDatabase_v22 = function(dbName, cb) {
-	var database = new Database(this._cluster.openDatabase(dbName));
-	return future.resolve(database)(cb);
+	return openDatabaseAsync(this, dbName, cb);
 };
 
 var Cluster = function(_cluster) {
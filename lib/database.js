@@ -28,6 +28,12 @@ var future = require('./future');
 var fdb = require('./fdbModule');
 var fdbUtil = require('./fdbUtil');
 var apiVersion = require('./apiVersion');
+var parallelScan = require('./parallelScan');
+var KeySelector = require('./keySelector');
+var RangeStream = require('./rangeStream');
+var rangeIterator = require('./rangeIterator');
+var ValueCache = require('./valueCache');
+var WriteBatcher = require('./writeBatcher');
 
 var onError = function(tr, err, func, cb) {
 	tr.onError(err, function(retryErr, retryRes) {
@@ -43,6 +49,10 @@ var retryLoop = function(tr, func, cb) {
 		if(err) {
 			onError(tr, err, func, cb);
 		}
+		else if(!tr._needsCommit) {
+			// Committing a transaction that only read has no effect
+			cb(undefined, res);
+		}
 		else {
 			tr.commit(function(commitErr, commitRes) {
 				if(commitErr)
@@ -56,31 +66,207 @@ var retryLoop = function(tr, func, cb) {
 
 var atomic = function(db, op) {
 	return function(key, value, cb) {
+		if(db._writeBatcher && db._writeBatcher.supportsAtomic(op)) {
+			key = fdbUtil.keyToBuffer(key);
+			value = fdbUtil.valueToBuffer(value);
+			if(db._writeBatcher.accepts(key, value))
+				return db._writeBatcher.atomicOp(op, key, value, cb);
+		}
+
 		return db.doTransaction(function(tr, innerCb) {
-			fdb.atomic[op].call(tr.tr, fdbUtil.keyToBuffer(key), fdbUtil.valueToBuffer(value));
+			tr[op](key, value);
 			innerCb();
 		}, cb);
 	};
 };
 
+// Reads the batches of a range across as many transactions as it takes. After a
+// retryable error, reading resumes in a new transaction after the last key read.
+var resumableRangeReader = function(db, start, end, options) {
+	if(!KeySelector.isKeySelector(start))
+		start = KeySelector.firstGreaterOrEqual(start);
+	if(!KeySelector.isKeySelector(end))
+		end = KeySelector.firstGreaterOrEqual(end);
+
+	var limit = options.limit || 0;
+	var limitReached = false;
+	var tr, readBatch;
+
+	var open = function() {
+		tr = db.createTransaction();
+		readBatch = tr.getRange(start, end, {
+			limit: limit,
+			reverse: options.reverse,
+			streamingMode: options.streamingMode,
+			packed: options.packed,
+			prefetch: options.prefetch,
+			prefetchBytes: options.prefetchBytes
+		}).batchReader();
+	};
+
+	var read = function(cb) {
+		if(limitReached)
+			return cb();
+
+		readBatch(function(err, batch) {
+			if(err) {
+				tr.onError(err, function(retryErr) {
+					if(retryErr)
+						cb(retryErr);
+					else {
+						open();
+						read(cb);
+					}
+				});
+			}
+			else {
+				if(batch) {
+					if(options.reverse)
+						end = KeySelector.firstGreaterOrEqual(rangeIterator.lastKey(batch));
+					else
+						start = KeySelector.firstGreaterThan(rangeIterator.lastKey(batch));
+
+					if(limit) {
+						limit -= batch.length;
+						limitReached = limit <= 0;
+					}
+				}
+
+				cb(undefined, batch);
+			}
+		});
+	};
+
+	open();
+	return read;
+};
+
 var Database = function(_db) {
 	this._db = _db;
 	this.options = _db.options;
 
+	this._transactionPool = [];
+	this._transactionPoolSize = 0;
+
+	this._writeBatcher = undefined;
+
+	this._readVersionMaxAge = 0;
+	this._readVersion = undefined;
+	this._readVersionTime = 0;
+
 	for(var op in fdb.atomic)
 		this[op] = atomic(this, op);
 };
 
 Database.prototype.createTransaction = function() {
-	return new Transaction(this, this._db.createTransaction());
+	var tr = new Transaction(this, this._db.createTransaction());
+	if(this._zeroCopyResults)
+		tr.setZeroCopyResults(true);
+
+	return tr;
+};
+
+// Transactions created from this database return buffers that share memory with
+// their underlying futures rather than copies (see Transaction.setZeroCopyResults)
+Database.prototype.setZeroCopyResults = function(enable) {
+	this._zeroCopyResults = !!enable;
+};
+
+/*
+ * Keeps up to size transactions that doTransaction has finished with and reuses them,
+ * after a reset, for later calls to doTransaction. Defaults to 0 (no pooling). With
+ * pooling enabled, a transaction must not be used once doTransaction's callback has
+ * returned. Transactions that created watches or range reads are never reused, since
+ * a watch or range iterator can outlive the callback and would otherwise keep using
+ * the transaction after it has been handed to an unrelated doTransaction.
+ */
+Database.prototype.setTransactionPoolSize = function(size) {
+	this._transactionPoolSize = size;
+	if(this._transactionPool.length > size)
+		this._transactionPool.length = size;
+};
+
+var acquireTransaction = function(db) {
+	if(db._transactionPool.length > 0)
+		return db._transactionPool.pop();
+
+	return db.createTransaction();
+};
+
+var releaseTransaction = function(db, tr) {
+	if(!tr._watched && !tr._rangeRead && db._transactionPool.length < db._transactionPoolSize) {
+		tr.reset();
+		db._transactionPool.push(tr);
+	}
+};
+
+/*
+ * Lets transactions started by doTransaction share read versions. A transaction
+ * started within maxAge milliseconds of the last version this database observed
+ * (from a read version or a commit) uses that version instead of requesting its own.
+ * Reads may then miss writes committed by other clients during that window.
+ * maxAge must stay well below the 5 second transaction lifetime; 0 disables the cache.
+ */
+Database.prototype.setReadVersionCache = function(maxAge) {
+	this._readVersionMaxAge = maxAge;
+	this._readVersion = undefined;
+};
+
+var observeReadVersion = function(db, version, time) {
+	if(db._readVersion === undefined || version > db._readVersion) {
+		db._readVersion = version;
+		db._readVersionTime = time;
+	}
+};
+
+var useCachedReadVersion = function(db, tr) {
+	var now = Date.now();
+	if(db._readVersion !== undefined && now - db._readVersionTime <= db._readVersionMaxAge) {
+		tr.setReadVersion(db._readVersion);
+	}
+	else {
+		// The transaction's own reads share this request, so populating the cache costs nothing extra
+		tr.getReadVersion(function(err, version) {
+			if(!err)
+				observeReadVersion(db, version, now);
+		});
+	}
+};
+
+var runTransaction = function(db, tr, func, cb) {
+	if(db._transactionPoolSize === 0 && !db._readVersionMaxAge)
+		retryLoop(tr, func, cb);
+	else {
+		retryLoop(tr, func, function(err, res) {
+			// Retries never reuse the cached version, because onError resets the transaction.
+			// Observing the commit first lets transactions started by cb see its writes.
+			if(!err && db._readVersionMaxAge && tr._needsCommit)
+				observeReadVersion(db, tr.getCommittedVersion(), Date.now());
+
+			cb(err, res);
+
+			// Not before cb has returned, since cb may still use tr
+			if(!err)
+				releaseTransaction(db, tr);
+		});
+	}
 };
 
 Database.prototype.doTransaction = function(func, cb) {
-	var tr = this.createTransaction();
+	var db = this;
+	var tr = acquireTransaction(this);
+
+	if(this._readVersionMaxAge)
+		useCachedReadVersion(this, tr);
+
+	if(cb) {
+		runTransaction(db, tr, func, cb);
+		return;
+	}
 
 	return future.create(function(futureCb) {
-		retryLoop(tr, func, futureCb);
-	}, cb); 
+		runTransaction(db, tr, func, futureCb);
+	});
 };
 
 Database.prototype.get = function(key, cb) {
@@ -89,6 +275,12 @@ Database.prototype.get = function(key, cb) {
 	}, cb);
 };
 
+Database.prototype.getMany = function(keys, cb) {
+	return this.doTransaction(function(tr, innerCb) {
+		tr.getMany(keys, innerCb);
+	}, cb);
+};
+
 Database.prototype.getKey = function(keySelector, cb) {
 	return this.doTransaction(function(tr, innerCb) {	
 		tr.getKey(keySelector, innerCb);
@@ -112,6 +304,32 @@ Database.prototype.getRangeStartsWith = function(prefix, options, cb) {
 	}, cb);
 };
 
+// Scans a range as concurrent sub-scans split at shard boundaries (see parallelScan.js)
+Database.prototype.parallelScan = function(begin, end, options, func, cb) {
+	if(typeof options === 'function') {
+		cb = func;
+		func = options;
+		options = {};
+	}
+
+	return parallelScan(this, begin, end, options || {}, func, cb);
+};
+
+/*
+ * Returns a Readable stream of the range that fetches batches as the stream is read.
+ * Unlike tr.getRange(...).stream(), the read may span several transactions, so it is
+ * not guaranteed to be a consistent snapshot. See RangeStream for the stream options.
+ */
+Database.prototype.rangeStream = function(start, end, options) {
+	options = options || {};
+	return new RangeStream(resumableRangeReader(this, start, end, options), options);
+};
+
+// Returns a watch-invalidated cache of the values of keys in subspace (see valueCache.js)
+Database.prototype.cache = function(subspace, options) {
+	return new ValueCache(this, subspace, options);
+};
+
 Database.prototype.getAndWatch = function(key, cb) {
 	return this.doTransaction(function(tr, innerCb) {
 		tr.get(key, function(err, val) {
@@ -145,14 +363,46 @@ Database.prototype.clearAndWatch = function(key, cb) {
 	}, cb);
 };
 
+/*
+ * With options, set, clear, clearRange and atomic operations called on this database
+ * are committed in shared transactions (see writeBatcher.js for the options). Passing
+ * null commits any writes still being collected and turns batching off.
+ */
+Database.prototype.setWriteBatching = function(options) {
+	if(this._writeBatcher)
+		this._writeBatcher.flush();
+
+	this._writeBatcher = options ? new WriteBatcher(this, options) : undefined;
+};
+
 Database.prototype.set = function(key, value, cb) {
+	if(this._writeBatcher) {
+		key = fdbUtil.keyToBuffer(key);
+		value = fdbUtil.valueToBuffer(value);
+		if(this._writeBatcher.accepts(key, value))
+			return this._writeBatcher.set(key, value, cb);
+	}
+
 	return this.doTransaction(function(tr, innerCb) {
 		tr.set(key, value);
 		innerCb();
 	}, cb);
 };
 
+Database.prototype.applyMutations = function(mutations, cb) {
+	return this.doTransaction(function(tr, innerCb) {
+		tr.applyMutations(mutations);
+		innerCb();
+	}, cb);
+};
+
 Database.prototype.clear = function(key, cb) {
+	if(this._writeBatcher) {
+		key = fdbUtil.keyToBuffer(key);
+		if(this._writeBatcher.accepts(key))
+			return this._writeBatcher.clear(key, cb);
+	}
+
 	return this.doTransaction(function(tr, innerCb) {
 		tr.clear(key);
 		innerCb();
@@ -160,6 +410,13 @@ Database.prototype.clear = function(key, cb) {
 };
 
 Database.prototype.clearRange = function(start, end, cb) {
+	if(this._writeBatcher) {
+		start = fdbUtil.keyToBuffer(start);
+		end = fdbUtil.keyToBuffer(end);
+		if(this._writeBatcher.accepts(start, end))
+			return this._writeBatcher.clearRange(start, end, cb);
+	}
+
 	return this.doTransaction(function(tr, innerCb) {
 		tr.clearRange(start, end);
 		innerCb();
@@ -34,6 +34,7 @@ var FDBError = require('./error');
 var locality = require('./locality');
 var directory = require('./directory');
 var Subspace = require('./subspace');
+var MutationBuilder = require('./mutationBuilder');
 var selectedApiVersion = require('./apiVersion');
 
 var fdbModule = {};
@@ -64,10 +65,38 @@ module.exports = {
 			fdbModule.directory = directory.directory;
 			fdbModule.DirectoryLayer = directory.DirectoryLayer;
 			fdbModule.Subspace = Subspace;
+			fdbModule.MutationBuilder = MutationBuilder;
 
 			fdbModule.options = fdb.options;
 			fdbModule.streamingMode = fdb.streamingMode;
 
+			// Latency histograms and counters of the operations issued through the binding (see src/Stats.cpp)
+			fdbModule.stats = fdb.stats;
+			fdbModule.resetStats = fdb.resetStats;
+
+			/*
+			 * Bounds the work done delivering completed futures in one turn of the event loop.
+			 * options.maxCallbacks caps the number of callbacks and options.maxTime (in milliseconds)
+			 * the time spent; 0 or undefined means no limit. Futures over budget are delivered on
+			 * the next turn, after pending I/O. With options.prioritizeCommits, completed commits
+			 * are delivered before other futures, such as range reads.
+			 */
+			fdbModule.setDeliveryBudget = function(options) {
+				options = options || {};
+
+				var maxCallbacks = options.maxCallbacks || 0;
+				var maxTime = options.maxTime || 0;
+				if(typeof maxCallbacks !== 'number' || maxCallbacks < 0 || maxCallbacks % 1 !== 0)
+					throw new TypeError('maxCallbacks must be a non-negative integer');
+				if(typeof maxTime !== 'number' || maxTime < 0)
+					throw new TypeError('maxTime must be a non-negative number');
+
+				// The native budget is a signed 32-bit count
+				maxCallbacks = Math.min(maxCallbacks, 2147483647);
+
+				fdb.setDeliveryBudget(maxCallbacks, maxTime * 1000, !!options.prioritizeCommits);
+			};
+
 			var dbCache = {};
 			var clusterCache = {};
 
@@ -94,14 +123,69 @@ module.exports = {
 				if(!clusterFile)
 					clusterFile = '';
 
-				var cluster = new Cluster(fdb.createCluster(clusterFile));
+				if(version >= 23 && !cb)
+					return new Cluster(fdb.createCluster(clusterFile));
+
+				return future.create(function(futureCb) {
+					fdb.createCluster(clusterFile, function(err, cluster) {
+						if(err)
+							futureCb(err);
+						else
+							futureCb(undefined, new Cluster(cluster));
+					});
+				}, cb);
+			};
+
+			var pendingOpens = {};
+
+			var openAsync = function(clusterFile, databaseName, cb) {
+				var database = dbCache[[clusterFile, databaseName]];
+				if(database)
+					return future.resolve(database)(cb);
+
+				var pending = pendingOpens[[clusterFile, databaseName]];
+				if(pending)
+					return pending(cb);
+
+				var getCluster = function(clusterCb) {
+					var cluster = clusterCache[clusterFile];
+					if(cluster)
+						clusterCb(undefined, cluster);
+					else {
+						fdbModule.createCluster(clusterFile, function(err, cluster) {
+							if(!err && clusterCache)
+								clusterCache[clusterFile] = cluster;
+
+							clusterCb(err, cluster);
+						});
+					}
+				};
+
+				pending = future.create(function(futureCb) {
+					getCluster(function(err, cluster) {
+						if(err)
+							futureCb(err);
+						else {
+							cluster.openDatabase(databaseName, function(err, database) {
+								if(!err && dbCache)
+									dbCache[[clusterFile, databaseName]] = database;
+
+								futureCb(err, database);
+							});
+						}
+					});
+				});
+
+				pendingOpens[[clusterFile, databaseName]] = pending;
+				pending(function() {
+					delete pendingOpens[[clusterFile, databaseName]];
+				});
 
-				if(version < 23)
-					return future.resolve(cluster)(cb);
-				else
-					return cluster;
+				return pending(cb);
 			};
 
+			// Opens without blocking the event loop whenever the result is delivered through a future.
+			// With API versions >= 23, calling this without a callback returns the database synchronously.
 			fdbModule.open = function(clusterFile, databaseName, cb) {
 				if(!databaseName)
 					databaseName = 'DB';
@@ -111,54 +195,22 @@ module.exports = {
 
 				this.init();
 
-				var finish = function(err, database) {
-					if(version >= 23) //err will be undefined if version >= 23
-						return database;
-					else if(err)
-						return future.reject(err)(cb);
-					else
-						return future.resolve(database)(cb);
-				};
-
-				var updateDatabaseCacheAndFinish = function(err, database) {
-					if(!err)
-						dbCache[[clusterFile, databaseName]] = database;
-
-					return finish(err, database);
-				};
-
-				var getDatabase = function(cluster) {
-					var database = dbCache[[clusterFile, databaseName]];
-					if(database)
-						return finish(undefined, database);
-					else {
-						database = cluster.openDatabase(databaseName);
-						if(version >= 23)
-							return updateDatabaseCacheAndFinish(undefined, database);
-						else
-							return database(updateDatabaseCacheAndFinish);
-					}	
-				};
+				if(version < 23 || cb)
+					return openAsync(clusterFile, databaseName, cb);
 
-				var updateClusterCacheAndGetDatabase = function(err, cluster) {
-					if(err)
-						finish(err);
-					else {
+				var database = dbCache[[clusterFile, databaseName]];
+				if(!database) {
+					var cluster = clusterCache[clusterFile];
+					if(!cluster) {
+						cluster = fdbModule.createCluster(clusterFile);
 						clusterCache[clusterFile] = cluster;
-						return getDatabase(cluster);
 					}
-				};
 
-				var cluster = clusterCache[clusterFile];
-				if(cluster) 
-					return getDatabase(cluster);
-				else {
-					cluster = fdbModule.createCluster(clusterFile);
-					if(version >= 23)
-						return updateClusterCacheAndGetDatabase(undefined, cluster);
-					else
-						return cluster(updateClusterCacheAndGetDatabase);
+					database = cluster.openDatabase(databaseName);
+					dbCache[[clusterFile, databaseName]] = database;
 				}
+
+				return database;
 			};
 		}
 
@@ -26,6 +26,14 @@
 var buffer = require('./bufferConversion');
 var future = require('./future');
 
+var nativeModule;
+try {
+	nativeModule = require('./fdbModule');
+}
+catch(e) {
+	nativeModule = undefined;
+}
+
 var strinc = function(str) {
 	var buf = buffer(str);
 
@@ -80,6 +88,20 @@ var valueToBuffer = function(val) {
 	return buffer(val);
 };
 
+// The native transaction reads strings, Buffers, ArrayBuffers and TypedArrays in place, so only other
+// keys (such as objects with asFoundationDBKey) need converting before they are passed to it
+var isNativeBytes = function(obj) {
+	return typeof obj === 'string' || Buffer.isBuffer(obj) || obj instanceof ArrayBuffer || ArrayBuffer.isView(obj);
+};
+
+var keyToNative = function(key) {
+	return isNativeBytes(key) ? key : keyToBuffer(key);
+};
+
+var valueToNative = function(val) {
+	return isNativeBytes(val) ? val : valueToBuffer(val);
+};
+
 var buffersEqual = function(buf1, buf2) {
 	if(!buf1 || !buf2)
 		return buf1 === buf2;
@@ -94,11 +116,32 @@ var buffersEqual = function(buf1, buf2) {
 	return true;
 };
 
+// Whether the buffer key begins with the buffer prefix, compared without slicing key
+var startsWith = function(key, prefix) {
+	if(nativeModule) {
+		var result = nativeModule.startsWith(key, prefix);
+		if(typeof result === 'boolean')
+			return result;
+	}
+
+	if(key.length < prefix.length)
+		return false;
+
+	for(var i = 0; i < prefix.length; ++i)
+		if(key[i] !== prefix[i])
+			return false;
+
+	return true;
+};
+
 module.exports = { 
 	strinc: strinc, 
 	whileLoop: whileLoop, 
 	keyToBuffer: keyToBuffer, 
 	valueToBuffer: valueToBuffer,
-	buffersEqual: buffersEqual
+	keyToNative: keyToNative,
+	valueToNative: valueToNative,
+	buffersEqual: buffersEqual,
+	startsWith: startsWith
 };
 
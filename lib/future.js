@@ -34,8 +34,10 @@ function isObject(o) {
 var resolvePromise = function(promise, value) {
 	var called = false;
 	try {
-		if(promise === value)
+		if(promise === value) {
 			promise._state.reject(new TypeError('promise.then cannot be fulfilled with itself as the argument.'));
+			return;
+		}
 
 		if(isObject(value)) {
 			var then = value.then;
@@ -43,7 +45,7 @@ var resolvePromise = function(promise, value) {
 				then.call(value, function(res) {
 					if(!called) {
 						called = true;
-						resolvePromise(promise, res, promise);
+						resolvePromise(promise, res);
 					}
 				}, function(err) {
 					if(!called) {
@@ -64,71 +66,115 @@ var resolvePromise = function(promise, value) {
 	}
 };	
 
+/*
+ * A callback waiting on a future. Either a node-style callback (passed to future(cb)),
+ * or the handlers of a then() along with the future that then() returned.
+ */
+var Reaction = function(state, onFulfilled, onRejected, target, callback) {
+	this.state = state;
+	this.onFulfilled = onFulfilled;
+	this.onRejected = onRejected;
+	this.target = target;
+	this.callback = callback;
+};
+
+Reaction.prototype.run = function() {
+	var state = this.state;
+
+	if(this.callback) {
+		// As when this went through then(), an exception thrown by the callback has nowhere to go
+		try {
+			if(state.rejected)
+				this.callback(state.error);
+			else
+				this.callback(undefined, state.value);
+		}
+		catch(error) { }
+
+		return;
+	}
+
+	var handler = state.rejected ? this.onRejected : this.onFulfilled;
+	try {
+		if(isFunction(handler))
+			resolvePromise(this.target, handler(state.rejected ? state.error : state.value));
+		else if(state.rejected)
+			this.target._state.reject(state.error);
+		else
+			resolvePromise(this.target, state.value);
+	}
+	catch(error) {
+		this.target._state.reject(error);
+	}
+};
+
+// Reactions of settled futures are run together from a single process.nextTick
+var pendingReactions = [];
+var flushScheduled = false;
+
+var flushReactions = function() {
+	// Reactions queued while flushing are run in the same pass
+	for(var i = 0; i < pendingReactions.length; ++i) {
+		var reaction = pendingReactions[i];
+		pendingReactions[i] = undefined;
+		reaction.run();
+	}
+
+	pendingReactions.length = 0;
+	flushScheduled = false;
+};
+
+var scheduleReaction = function(reaction) {
+	pendingReactions.push(reaction);
+	if(!flushScheduled) {
+		flushScheduled = true;
+		process.nextTick(flushReactions);
+	}
+};
+
 var FuturePrototype = {
 	cancel: function() {
 		//cancel is not implemented for most futures
 	},
 
 	then: function(onFulfilled, onRejected) {
-		var self = this;
 		var future = create();
-		this._state.addCallback(function(err, res) {
-			process.nextTick(function() {
-				try {
-					if(self._state.rejected) {
-						if(isFunction(onRejected))
-							res = onRejected(err);
-						else {
-							future._state.reject(err);
-							return;
-						}
-					}
-					else if(isFunction(onFulfilled))
-						res = onFulfilled(res);
-
-					resolvePromise(future, res);
-				}
-				catch(error) {
-					future._state.reject(error);
-				}
-			});
-		});
-
+		this._state.addReaction(new Reaction(this._state, onFulfilled, onRejected, future, undefined));
 		return future;
 	},
 
 	"catch": function(onRejected) {
-		this.then(undefined, onRejected);
+		return this.then(undefined, onRejected);
 	}
 };
 
-FuturePrototype.__proto__ = Function.__proto__;
-
 var FutureState = function() {
-	this.callbacks = [];
+	this.reactions = [];
 	this.fulfilled = false;
 	this.rejected = false;
+	this.value = undefined;
+	this.error = undefined;
 };
 
-FutureState.prototype.triggerCallbacks = function() {
-	for(var i = 0; i < this.callbacks.length; ++i)
-		this.callbacks[i](this.error, this.value);
+FutureState.prototype.triggerReactions = function() {
+	for(var i = 0; i < this.reactions.length; ++i)
+		scheduleReaction(this.reactions[i]);
 
-	this.callbacks = [];
+	this.reactions = null;
 };
 
-FutureState.prototype.addCallback = function(cb) {
+FutureState.prototype.addReaction = function(reaction) {
 	if(!this.rejected && !this.fulfilled)
-		this.callbacks.push(cb);
+		this.reactions.push(reaction);
 	else
-		cb(this.error, this.value);
+		scheduleReaction(reaction);
 };
 
 FutureState.prototype.fulfill = function(value) {
 	if(!this.fulfilled && !this.rejected) {
 		this.fulfilled = true;
 		this.value = value;
-		this.triggerCallbacks();
+		this.triggerReactions();
 	}
 };
 
@@ -136,7 +182,7 @@ FutureState.prototype.reject = function(reason) {
 	if(!this.fulfilled && !this.rejected) {
 		this.rejected = true;
 		this.error = reason;
-		this.triggerCallbacks();
+		this.triggerReactions();
 	}
 };
 
@@ -149,6 +195,12 @@ var getFutureCallback = function(futureState) {
 	};
 };
 
+/*
+ * When cb is given, func is passed cb directly and no future is created. Otherwise, the
+ * result is a future: a function that takes a node-style callback, and that also has the
+ * methods of FuturePrototype. They are copied onto each future rather than inherited, since
+ * assigning __proto__ on a function makes V8 deoptimize it and everything touching it.
+ */
 var create = function(func, cb) {
 	if(cb)
 		func(cb);
@@ -160,11 +212,13 @@ var create = function(func, cb) {
 			if(typeof callback === 'undefined')
 				return future;
 
-			future.then(function(val) { callback(undefined, val); }, callback);
+			futureState.addReaction(new Reaction(futureState, undefined, undefined, undefined, callback));
 		};
 
 		future._state = futureState;
-		future.__proto__ = FuturePrototype;
+		future.cancel = FuturePrototype.cancel;
+		future.then = FuturePrototype.then;
+		future["catch"] = FuturePrototype["catch"];
 
 		if(func)
 			func.call(future, getFutureCallback(futureState));
@@ -25,39 +25,111 @@
 
 var fdbUtil = require('./fdbUtil');
 var future = require('./future');
+var RangeStream = require('./rangeStream');
+
+var DEFAULT_PREFETCH_BYTES = 10 * 1024 * 1024;
+
+function batchBytes(results) {
+	if(!results)
+		return 0;
+	if(!(results instanceof Array))
+		return results.buffer.length;
+
+	var bytes = 0;
+	for(var i = 0; i < results.length; ++i)
+		bytes += results[i].key.length + results[i].value.length;
+
+	return bytes;
+}
+
+// Starts fetching the next batch if read-ahead is enabled and the queue of fetched batches has room
+function prefetch(state) {
+	if(state.prefetch && !state.fetching && !state.failed && !state.finished && !state.fetcher.finished &&
+		state.queue.length < state.prefetch && state.queuedBytes < state.prefetchBytes)
+	{
+		startFetch(state);
+	}
+}
+
+function deliver(state, batch) {
+	var cbs = state.fetchCallbacks;
+	state.fetchCallbacks = [];
+	state.results = batch.res;
+	state.index = -1;
+	state.finished = !batch.res || batch.res.length === 0;
+
+	// Read ahead while the consumer processes this batch
+	prefetch(state);
+
+	for(var i = 0; i < cbs.length; ++i)
+		cbs[i](batch.err);
+}
+
+function startFetch(state) {
+	state.fetching = true;
+	state.fetcher.fetch(function(err, res) {
+		var batch = { err: err, res: res, bytes: 0 };
+		state.fetching = false;
+		state.failed = state.failed || !!err;
+
+		if(state.fetchCallbacks.length > 0 || !state.prefetch)
+			deliver(state, batch);
+		else {
+			batch.bytes = batchBytes(res);
+			state.queue.push(batch);
+			state.queuedBytes += batch.bytes;
+			prefetch(state);
+		}
+	});
+}
 
 function fetch(state, cb) {
 	if(cb)
 		state.fetchCallbacks.push(cb);
-	if(!state.fetching) {
-		state.fetching = true;
-		state.fetcher.fetch(function(err, res) {
-			var cbs = state.fetchCallbacks;
-			state.fetching = false;
-			state.fetchCallbacks = [];
-			state.results = res;
-			state.index = -1;
-			state.finished = !res || res.length === 0;
 
-			for(var i = 0; i < cbs.length; ++i)
-				cbs[i](err);
-		});
+	if(state.queue.length > 0) {
+		var batch = state.queue.shift();
+		state.queuedBytes -= batch.bytes;
+		deliver(state, batch);
 	}
+	else if(!state.fetching)
+		startFetch(state);
 }
 
-function iterState(fetcher) {
+// Batches are either arrays of KeyValue objects or packed batches that materialize rows on demand
+function resultAt(results, index) {
+	return results instanceof Array ? results[index] : results.get(index);
+}
+
+function batchToArray(results) {
+	return results instanceof Array ? results : results.toArray();
+}
+
+function iterState(fetcher, options) {
 	return {
 		index: -1,
 		results: undefined,
 
 		fetching: false,
 		fetchCallbacks: [],
-		fetcher: fetcher
+		fetcher: fetcher,
+
+		// Batches fetched ahead of the consumer
+		prefetch: (options && options.prefetch) || 0,
+		prefetchBytes: (options && options.prefetchBytes) || DEFAULT_PREFETCH_BYTES,
+		queue: [],
+		queuedBytes: 0,
+		failed: false
 	};
 }
 
-var LazyIterator = function(Fetcher) {
+/*
+ * options.prefetch is the number of batches that iteration may fetch ahead of the
+ * consumer (default 0), and options.prefetchBytes caps the size of those batches.
+ */
+var LazyIterator = function(Fetcher, options) {
 	this.Fetcher = Fetcher;
+	this.options = options || {};
 	this.stateForNext = undefined;
 
 	this.startState = iterState(new Fetcher());
@@ -66,8 +138,8 @@ var LazyIterator = function(Fetcher) {
 	fetch(this.startState);
 };
 
-function copyState(state, wantAll) {
-	var newState = iterState();
+function copyState(state, wantAll, options) {
+	var newState = iterState(undefined, options);
 	newState.index = state.index;
 	newState.results = state.results;
 	newState.fetching = state.fetching;
@@ -81,12 +153,16 @@ function copyState(state, wantAll) {
 			newState.fetchCallbacks = [];
 			newState.finished = state.finished;
 			newState.fetcher = state.fetcher.clone(wantAll);
+			if(!err)
+				prefetch(newState);
+
 			for(var i = 0; i < cbs.length; ++i)
 				cbs[i](err);
 		});
 	}
 	else {
 		newState.fetcher = state.fetcher.clone(wantAll);
+		prefetch(newState);
 	}
 
 	return newState;
@@ -96,7 +172,7 @@ function nextImpl(state, cb) {
 	if(state.finished)
 		cb();
 	else if(state.results && (state.index + 1) < state.results.length)
-		cb(null, state.results[++state.index]);
+		cb(null, resultAt(state.results, ++state.index));
 	else {
 		fetch(state, function(err) {
 			if(err)
@@ -113,7 +189,7 @@ LazyIterator.prototype.next = function(cb) {
 	var itr = this;
 	return future.create(function(futureCb) {
 		if(!itr.stateForNext)
-			itr.stateForNext = copyState(itr.startState);
+			itr.stateForNext = copyState(itr.startState, false, itr.options);
 
 		nextImpl(itr.stateForNext, futureCb);
 	}, cb);
@@ -122,7 +198,7 @@ LazyIterator.prototype.next = function(cb) {
 LazyIterator.prototype.forEach = function(func, cb) {
 	var itr = this;
 	return future.create(function(futureCb) {
-		var state = copyState(itr.startState);
+		var state = copyState(itr.startState, false, itr.options);
 
 		fdbUtil.whileLoop(function(loopCb) {
 			nextImpl(state, function(err, res) {
@@ -136,49 +212,177 @@ LazyIterator.prototype.forEach = function(func, cb) {
 	}, cb);
 };
 
-function forEachBatchImpl(state, func, cb) {
-	function loopBody(loopCb) {
-		function processBatch(err) {
-			if(err || state.finished)
-				loopCb(err, null);
-			else {
-				state.index = state.results.length;
-				func(state.results, loopCb);
-			}
+// Calls cb with the next unconsumed batch of state, or with no batch once iteration has finished
+function nextBatch(state, cb) {
+	function takeBatch(err) {
+		if(err || state.finished)
+			cb(err);
+		else {
+			state.index = state.results.length;
+			cb(undefined, state.results);
 		}
-
-		if(!state.results || state.index === state.results.length)
-			fetch(state, processBatch);
-		else
-			processBatch();
 	}
 
-	fdbUtil.whileLoop(loopBody, cb);
+	if(!state.results || state.index === state.results.length)
+		fetch(state, takeBatch);
+	else
+		takeBatch();
+}
+
+function forEachBatchImpl(state, func, cb) {
+	fdbUtil.whileLoop(function(loopCb) {
+		nextBatch(state, function(err, batch) {
+			if(err || !batch)
+				loopCb(err, null);
+			else
+				func(batch, loopCb);
+		});
+	}, cb);
 }
 
 LazyIterator.prototype.forEachBatch = function(func, cb) {
 	var itr = this;
 	return future.create(function(futureCb) {
-		forEachBatchImpl(copyState(itr.startState), func, futureCb);
+		forEachBatchImpl(copyState(itr.startState, false, itr.options), func, futureCb);
 	}, cb);
 };
 
+// Concatenates batches into one presized array
+function joinBatches(batches) {
+	if(batches.length === 1)
+		return batchToArray(batches[0]);
+
+	var length = 0;
+	for(var i = 0; i < batches.length; ++i)
+		length += batches[i].length;
+
+	var result = new Array(length);
+	var pos = 0;
+	for(i = 0; i < batches.length; ++i)
+		for(var j = 0; j < batches[i].length; ++j)
+			result[pos++] = resultAt(batches[i], j);
+
+	return result;
+}
+
+/*
+ * Collects the remaining results of state. Batches that have already been fetched
+ * or requested are used first; once there are none, fetchers that support it read
+ * the rest of the range with a single call to fetchAll.
+ */
+function toArrayImpl(state, cb) {
+	var batches = [];
+
+	fdbUtil.whileLoop(function(loopCb) {
+		var pending = state.fetching || state.queue.length > 0 || (state.results && state.index + 1 < state.results.length);
+		if(!pending && !state.finished && state.fetcher.fetchAll) {
+			state.fetcher.fetchAll(function(err, res) {
+				if(!err && res && res.length > 0)
+					batches.push(res);
+
+				state.finished = true;
+				loopCb(err, null);
+			});
+		}
+		else {
+			nextBatch(state, function(err, batch) {
+				if(err || !batch)
+					loopCb(err, null);
+				else {
+					batches.push(batch);
+					loopCb();
+				}
+			});
+		}
+	}, function(err) {
+		if(err)
+			cb(err);
+		else
+			cb(null, joinBatches(batches));
+	});
+}
+
 LazyIterator.prototype.toArray = function(cb) {
 	var itr = this;
 	return future.create(function(futureCb) {
-		var state = copyState(itr.startState, true);
-		var result = [];
+		toArrayImpl(copyState(itr.startState, true, itr.options), futureCb);
+	}, cb);
+};
+
+// Returns a function that reads the batches of a fresh iteration one at a time
+LazyIterator.prototype.batchReader = function() {
+	var state = copyState(this.startState, false, this.options);
+	return function(cb) {
+		nextBatch(state, cb);
+	};
+};
+
+// Returns a Readable stream of the results that only fetches batches as the stream is read
+LazyIterator.prototype.stream = function(options) {
+	return new RangeStream(this.batchReader(), options);
+};
 
-		forEachBatchImpl(state, function(arr, itrCb) {
-			result = result.concat(arr);
-			itrCb();
-		}, function(err, res) {
+/*
+ * Async iteration, where the runtime supports it. Rows are served synchronously out of
+ * the current batch, so the only waiting (and the only callback from the fetcher) is
+ * once per batch. Iterating batches() costs one promise per batch rather than per row.
+ */
+var AsyncRangeIterator = function(state, wantBatches) {
+	this.state = state;
+	this.wantBatches = wantBatches;
+	this.batch = undefined;
+	this.index = 0;
+	this.done = false;
+};
+
+AsyncRangeIterator.prototype.next = function() {
+	if(this.batch && this.index < this.batch.length)
+		return Promise.resolve({ value: resultAt(this.batch, this.index++), done: false });
+
+	var itr = this;
+	return new Promise(function(resolve, reject) {
+		if(itr.done)
+			return resolve({ value: undefined, done: true });
+
+		nextBatch(itr.state, function(err, batch) {
 			if(err)
-				futureCb(err);
-			else
-				futureCb(null, result);
+				reject(err);
+			else if(!batch || itr.done) {
+				itr.done = true;
+				itr.batch = undefined;
+				resolve({ value: undefined, done: true });
+			}
+			else if(itr.wantBatches)
+				resolve({ value: batch, done: false });
+			else {
+				itr.batch = batch;
+				itr.index = 1;
+				resolve({ value: resultAt(batch, 0), done: false });
+			}
 		});
-	}, cb);
+	});
+};
+
+// Called when a for await loop exits early
+AsyncRangeIterator.prototype['return'] = function(value) {
+	this.done = true;
+	this.batch = undefined;
+	return Promise.resolve({ value: value, done: true });
 };
 
+if(typeof Symbol === 'function' && Symbol.asyncIterator) {
+	AsyncRangeIterator.prototype[Symbol.asyncIterator] = function() {
+		return this;
+	};
+
+	LazyIterator.prototype[Symbol.asyncIterator] = function() {
+		return new AsyncRangeIterator(copyState(this.startState, false, this.options), false);
+	};
+
+	// for await(var batch of iterator.batches()) yields the batches of a fresh iteration
+	LazyIterator.prototype.batches = function() {
+		return new AsyncRangeIterator(copyState(this.startState, false, this.options), true);
+	};
+}
+
 module.exports = LazyIterator;
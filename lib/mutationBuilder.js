@@ -0,0 +1,153 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var fdbUtil = require('./fdbUtil');
+
+// Record opcodes understood by the native applyMutations
+var SET = 0;
+var CLEAR = 1;
+var CLEAR_RANGE = 2;
+var ATOMIC = 3;
+
+// FDBMutationType codes of the atomic operations (see FdbOptions.g.cpp)
+var mutationTypes = {
+	add: 2,
+	and: 6,
+	bitAnd: 6,
+	or: 7,
+	bitOr: 7,
+	xor: 8,
+	bitXor: 8,
+	max: 12,
+	min: 13
+};
+
+/*
+ * Encodes a batch of mutations into a reusable buffer that can be applied to
+ * a transaction in a single native call with Transaction.applyMutations.
+ */
+var MutationBuilder = function(initialSize) {
+	this.buffer = new Buffer(initialSize || 4096);
+	this.length = 0;
+	this.count = 0;
+};
+
+MutationBuilder.prototype.reserve = function(bytes) {
+	var required = this.length + bytes;
+	if(required > this.buffer.length) {
+		var newSize = this.buffer.length * 2;
+		while(newSize < required)
+			newSize *= 2;
+
+		var newBuffer = new Buffer(newSize);
+		this.buffer.copy(newBuffer, 0, 0, this.length);
+		this.buffer = newBuffer;
+	}
+};
+
+MutationBuilder.prototype.writeByte = function(b) {
+	this.reserve(1);
+	this.buffer[this.length++] = b;
+};
+
+MutationBuilder.prototype.writeBytes = function(bytes) {
+	var length;
+	if(typeof bytes === 'string') {
+		length = Buffer.byteLength(bytes, 'utf8');
+		this.reserve(4 + length);
+		this.buffer.writeUInt32LE(length, this.length, true);
+		this.buffer.write(bytes, this.length + 4, length, 'utf8');
+	}
+	else {
+		length = bytes.length;
+		this.reserve(4 + length);
+		this.buffer.writeUInt32LE(length, this.length, true);
+		bytes.copy(this.buffer, this.length + 4);
+	}
+
+	this.length += 4 + length;
+};
+
+function toBytes(key) {
+	return typeof key === 'string' ? key : fdbUtil.keyToBuffer(key);
+}
+
+function valueToBytes(value) {
+	return typeof value === 'string' ? value : fdbUtil.valueToBuffer(value);
+}
+
+MutationBuilder.prototype.set = function(key, value) {
+	this.writeByte(SET);
+	this.writeBytes(toBytes(key));
+	this.writeBytes(valueToBytes(value));
+	++this.count;
+	return this;
+};
+
+MutationBuilder.prototype.clear = function(key) {
+	this.writeByte(CLEAR);
+	this.writeBytes(toBytes(key));
+	++this.count;
+	return this;
+};
+
+MutationBuilder.prototype.clearRange = function(start, end) {
+	this.writeByte(CLEAR_RANGE);
+	this.writeBytes(toBytes(start));
+	this.writeBytes(toBytes(end));
+	++this.count;
+	return this;
+};
+
+MutationBuilder.prototype.atomicOp = function(op, key, param) {
+	var type = mutationTypes[op];
+	if(typeof type === 'undefined')
+		throw new TypeError('Unknown atomic operation: ' + op);
+
+	this.writeByte(ATOMIC);
+	this.writeByte(type);
+	this.writeBytes(toBytes(key));
+	this.writeBytes(valueToBytes(param));
+	++this.count;
+	return this;
+};
+
+MutationBuilder.isAtomicOp = function(op) {
+	return mutationTypes.hasOwnProperty(op);
+};
+
+Object.keys(mutationTypes).forEach(function(op) {
+	MutationBuilder.prototype[op] = function(key, param) {
+		return this.atomicOp(op, key, param);
+	};
+});
+
+// Discards the encoded mutations but keeps the buffer for reuse
+MutationBuilder.prototype.reset = function() {
+	this.length = 0;
+	this.count = 0;
+};
+
+module.exports = MutationBuilder;
@@ -0,0 +1,297 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var future = require('./future');
+var fdb = require('./fdbModule');
+var fdbUtil = require('./fdbUtil');
+var KeySelector = require('./keySelector');
+var rangeIterator = require('./rangeIterator');
+
+var PAST_VERSION_ERROR_CODE = 1007;
+
+function Partition(index, begin, end) {
+	this.index = index;
+	this.begin = begin;
+	this.end = end;
+	this.lastKey = undefined;
+	this.done = false;
+
+	// Ordered scans only: batches waiting for earlier partitions, and the paused scan of this partition
+	this.batches = [];
+	this.resume = undefined;
+}
+
+function Scanner(db, readVersion, options, func, cb) {
+	this.db = db;
+	this.readVersion = readVersion;
+	this.func = func;
+	this.cb = cb;
+
+	this.ordered = !!options.ordered;
+	this.concurrency = options.concurrency || 4;
+	this.bufferBatches = options.bufferBatches || 4;
+	this.streamingMode = typeof options.streamingMode === 'undefined' ? fdb.streamingMode.wantAll : options.streamingMode;
+	this.packed = !!options.packed;
+	this.prefetch = options.prefetch;
+
+	this.partitions = [];
+	this.nextToStart = 0;
+	this.active = 0;
+	this.completed = 0;
+
+	this.cursor = 0;
+	this.delivering = false;
+
+	this.finished = false;
+}
+
+Scanner.prototype.finish = function(err) {
+	if(this.finished)
+		return;
+
+	this.finished = true;
+	this.error = err;
+
+	if(err) {
+		for(var i = 0; i < this.partitions.length; ++i) {
+			var resume = this.partitions[i].resume;
+			this.partitions[i].resume = undefined;
+			if(resume)
+				resume(undefined, null);
+		}
+	}
+
+	this.cb(err, err ? undefined : this.readVersion);
+};
+
+Scanner.prototype.startPartitions = function() {
+	while(this.active < this.concurrency && this.nextToStart < this.partitions.length) {
+		// Ordered scans don't run further ahead of the partition being delivered than the concurrency allows
+		if(this.ordered && this.nextToStart >= this.cursor + this.concurrency)
+			break;
+
+		var partition = this.partitions[this.nextToStart++];
+		++this.active;
+		this.scan(partition, partition.begin);
+	}
+};
+
+Scanner.prototype.scan = function(partition, begin) {
+	var scanner = this;
+	var tr = this.db.createTransaction();
+	tr.setReadVersion(this.readVersion);
+
+	var rangeOptions = { streamingMode: this.streamingMode, packed: this.packed, prefetch: this.prefetch };
+	tr.snapshot.getRange(begin, partition.end, rangeOptions).forEachBatch(function(kvs, loopCb) {
+		if(scanner.finished)
+			return loopCb(undefined, null);
+
+		partition.lastKey = rangeIterator.lastKey(kvs);
+		scanner.onBatch(partition, kvs, loopCb);
+	}, function(err) {
+		if(scanner.finished)
+			return;
+
+		if(!err)
+			scanner.onPartitionDone(partition);
+		// The read version is pinned, so there is no point retrying once it is too old
+		else if(err.code === PAST_VERSION_ERROR_CODE)
+			scanner.finish(err);
+		else {
+			tr.onError(err, function(retryErr) {
+				if(retryErr)
+					scanner.finish(retryErr);
+				else if(!scanner.finished)
+					scanner.scan(partition, partition.lastKey ? KeySelector.firstGreaterThan(partition.lastKey) : partition.begin);
+			});
+		}
+	});
+};
+
+Scanner.prototype.onBatch = function(partition, kvs, loopCb) {
+	var scanner = this;
+
+	if(!this.ordered) {
+		this.func(kvs, partition.index, function(err) {
+			if(err)
+				scanner.finish(err);
+
+			loopCb(err);
+		});
+	}
+	else {
+		partition.batches.push(kvs);
+		if(partition.batches.length < this.bufferBatches)
+			loopCb();
+		else
+			partition.resume = loopCb;
+
+		this.deliverOrdered();
+	}
+};
+
+Scanner.prototype.onPartitionDone = function(partition) {
+	partition.done = true;
+	--this.active;
+	++this.completed;
+
+	if(this.ordered)
+		this.deliverOrdered();
+	else if(this.completed === this.partitions.length)
+		this.finish();
+
+	this.startPartitions();
+};
+
+// Hands batches to func in key order: the partitions are disjoint and sorted, so
+// merging them amounts to draining each partition before moving to the next one
+Scanner.prototype.deliverOrdered = function() {
+	if(this.delivering)
+		return;
+
+	this.delivering = true;
+
+	var scanner = this;
+	var calledBack;
+	var inLoop;
+
+	var next = function(err) {
+		if(err)
+			return scanner.finish(err);
+
+		if(inLoop)
+			calledBack = true;
+		else {
+			scanner.delivering = false;
+			scanner.deliverOrdered();
+		}
+	};
+
+	while(!this.finished) {
+		var partition = this.partitions[this.cursor];
+		while(partition && partition.done && partition.batches.length === 0) {
+			partition = this.partitions[++this.cursor];
+			this.startPartitions();
+		}
+
+		if(!partition) {
+			this.delivering = false;
+			return this.finish();
+		}
+
+		if(partition.batches.length === 0) {
+			this.delivering = false;
+			return;
+		}
+
+		var kvs = partition.batches.shift();
+		if(partition.resume) {
+			var resume = partition.resume;
+			partition.resume = undefined;
+			resume();
+		}
+
+		calledBack = false;
+		inLoop = true;
+		this.func(kvs, partition.index, next);
+		inLoop = false;
+
+		if(!calledBack)
+			return;
+	}
+};
+
+function getReadVersion(db, options, cb) {
+	if(typeof options.readVersion !== 'undefined')
+		cb(undefined, options.readVersion);
+	else
+		db.createTransaction().getReadVersion(cb);
+}
+
+function getPartitionBounds(db, readVersion, begin, end, cb) {
+	// Required here rather than at load time because locality depends on database
+	var locality = require('./locality');
+
+	var tr = db.createTransaction();
+	tr.setReadVersion(readVersion);
+
+	locality.getBoundaryKeys(tr, begin, end, function(err, boundaryKeys) {
+		if(err)
+			return cb(err);
+
+		boundaryKeys.toArray(function(err, keys) {
+			if(err)
+				return cb(err);
+
+			var bounds = [begin];
+			for(var i = 0; i < keys.length; ++i) {
+				if(Buffer.compare(keys[i], begin) > 0 && Buffer.compare(keys[i], end) < 0)
+					bounds.push(keys[i]);
+			}
+			bounds.push(end);
+
+			cb(undefined, bounds);
+		});
+	});
+}
+
+/*
+ * Reads [begin, end) as a set of sub-scans split at shard boundaries and run
+ * concurrently at a single read version, so together they see a consistent
+ * snapshot. func(kvs, partitionIndex, cb) is called for each batch read.
+ *
+ * Options:
+ *   concurrency:   number of sub-scans to run at once (default 4)
+ *   readVersion:   read version to scan at (default: a new read version)
+ *   ordered:       if true, batches are passed to func one at a time in key order;
+ *                  otherwise, each partition calls func as its batches arrive
+ *   bufferBatches: for ordered scans, how many batches a partition may read ahead
+ *                  of delivery before it pauses (default 4)
+ *
+ * streamingMode, packed and prefetch are passed on to each sub-scan's getRange.
+ * The returned future resolves to the read version used.
+ */
+module.exports = function(db, begin, end, options, func, cb) {
+	begin = fdbUtil.keyToBuffer(begin);
+	end = fdbUtil.keyToBuffer(end);
+
+	return future.create(function(futureCb) {
+		getReadVersion(db, options, function(err, readVersion) {
+			if(err)
+				return futureCb(err);
+
+			getPartitionBounds(db, readVersion, begin, end, function(err, bounds) {
+				if(err)
+					return futureCb(err);
+
+				var scanner = new Scanner(db, readVersion, options, func, futureCb);
+				for(var i = 0; i < bounds.length - 1; ++i)
+					scanner.partitions.push(new Partition(i, bounds[i], bounds[i+1]));
+
+				scanner.startPartitions();
+			});
+		});
+	}, cb);
+};
@@ -23,7 +23,6 @@
 
 "use strict";
 
-var KeySelector = require('./keySelector');
 var Future = require('./future');
 var fdb = require('./fdbModule');
 var LazyIterator = require('./lazyIterator');
@@ -39,6 +38,43 @@ function getStreamingMode(requestedMode, limit, wantAll) {
 	return requestedMode;
 }
 
+/*
+ * A batch of key-value pairs returned by getRangePacked. All keys and values
+ * live in one buffer; rows are only materialized when they are accessed.
+ */
+var PackedRange = function(res) {
+	this.buffer = res.buffer;
+	this.offsets = res.offsets;
+	this.length = (res.offsets.length - 1) / 2;
+};
+
+PackedRange.prototype.key = function(index) {
+	return this.buffer.slice(this.offsets[2*index], this.offsets[2*index+1]);
+};
+
+PackedRange.prototype.value = function(index) {
+	return this.buffer.slice(this.offsets[2*index+1], this.offsets[2*index+2]);
+};
+
+PackedRange.prototype.get = function(index) {
+	return { key: this.key(index), value: this.value(index) };
+};
+
+PackedRange.prototype.toArray = function() {
+	var arr = new Array(this.length);
+	for(var i = 0; i < this.length; ++i)
+		arr[i] = this.get(i);
+
+	return arr;
+};
+
+function lastKey(results) {
+	if(results instanceof PackedRange)
+		return results.key(results.length-1);
+	else
+		return results[results.length-1].key;
+}
+
 module.exports = function(tr, start, end, options, snapshot) {
 	if(!options)
 		options = {};
@@ -50,23 +86,16 @@ module.exports = function(tr, start, end, options, snapshot) {
 	if(!options.streamingMode && options.streamingMode !== 0)
 		options.streamingMode = fdb.streamingMode.iterator;
 
-	var RangeFetcher = function(wantAll) {
+	// The native RangeSpec is created once and advanced in place as batches are read (see src/Transaction.cpp)
+	var RangeFetcher = function(wantAll, spec) {
 		this.finished = false;
-		this.limit = options.limit;
-		this.iterStart = start;
-		this.iterEnd = end;
-		this.iterationCount = 1;
-		this.streamingMode = getStreamingMode(options.streamingMode, this.limit, wantAll);
+		this.streamingMode = getStreamingMode(options.streamingMode, options.limit, wantAll);
+		this.spec = spec || new fdb.RangeSpec(start.key, start.orEqual, start.offset, end.key, end.orEqual, end.offset, options.limit, this.streamingMode, snapshot, options.reverse);
 	};
 
 	RangeFetcher.prototype.clone = function(wantAll) {
-		var clone = new RangeFetcher(wantAll);
-
+		var clone = new RangeFetcher(wantAll, this.spec.clone(getStreamingMode(options.streamingMode, options.limit, wantAll)));
 		clone.finished = this.finished;
-		clone.limit = this.limit;
-		clone.iterStart = this.iterStart;
-		clone.iterEnd = this.iterEnd;
-		clone.iterationCount = this.iterationCount;
 
 		return clone;
 	};
@@ -77,25 +106,14 @@ module.exports = function(tr, start, end, options, snapshot) {
 			cb();
 		}
 		else {
-			tr.getRange(fetcher.iterStart.key, fetcher.iterStart.orEqual, fetcher.iterStart.offset, fetcher.iterEnd.key, fetcher.iterEnd.orEqual, fetcher.iterEnd.offset, fetcher.limit, fetcher.streamingMode, fetcher.iterationCount++, snapshot, options.reverse, function(err, res) 
-			{
+			var getRange = options.packed ? tr.getRangePacked : tr.getRange;
+			getRange.call(tr, fetcher.spec, function(err, res) {
 				if(!err) {
-					var results = res.array;
-					if(results.length > 0) {
-						if(!options.reverse)
-							fetcher.iterStart = KeySelector.firstGreaterThan(results[results.length-1].key);
-						else
-							fetcher.iterEnd = KeySelector.firstGreaterOrEqual(results[results.length-1].key);
-					}
-
-					if(fetcher.limit !== 0) {
-						fetcher.limit -= results.length;
-						if(fetcher.limit <= 0)
-							fetcher.finished = true;
-					}
+					// more is only set when the range has more to read and the limit has not been reached
 					if(!res.more)
 						fetcher.finished = true;
-					cb(undefined, results);
+
+					cb(undefined, options.packed ? new PackedRange(res) : res.array);
 				}
 				else {
 					cb(err);
@@ -104,5 +122,27 @@ module.exports = function(tr, start, end, options, snapshot) {
 		}
 	};
 
-	return new LazyIterator(RangeFetcher);
+	// Reads everything left in the range with one native call that only returns once the range is exhausted
+	RangeFetcher.prototype.fetchAll = function(cb) {
+		var fetcher = this;
+		if(fetcher.finished) {
+			cb();
+		}
+		else {
+			fetcher.finished = true;
+
+			// The whole range comes back packed, so its rows are slices of one buffer rather than copies
+			tr.getRangeAll(fetcher.spec, function(err, res) {
+				if(!err)
+					cb(undefined, new PackedRange(res));
+				else
+					cb(err);
+			});
+		}
+	};
+
+	return new LazyIterator(RangeFetcher, options);
 };
+
+module.exports.PackedRange = PackedRange;
+module.exports.lastKey = lastKey;
@@ -0,0 +1,102 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var Readable = require('stream').Readable;
+var util = require('util');
+
+function rowAt(batch, index) {
+	return batch instanceof Array ? batch[index] : batch.get(index);
+}
+
+function valueAt(batch, index) {
+	return batch instanceof Array ? batch[index].value : batch.value(index);
+}
+
+/*
+ * A Readable stream over range read results. readBatch(cb) is called each time
+ * the stream wants more data and calls back with the next batch, or with no
+ * batch at the end of the range.
+ *
+ * By default, the stream is in object mode and emits {key, value} objects. If
+ * options.objectMode is false, it emits the bytes of the values instead.
+ */
+var RangeStream = function(readBatch, options) {
+	options = options || {};
+
+	var streamOptions = { objectMode: options.objectMode !== false };
+	if(typeof options.highWaterMark !== 'undefined')
+		streamOptions.highWaterMark = options.highWaterMark;
+
+	Readable.call(this, streamOptions);
+
+	this._readBatch = readBatch;
+	this._reading = false;
+	this._objectMode = streamOptions.objectMode;
+
+	// The batch being pushed and the index of its next row
+	this._batch = undefined;
+	this._index = 0;
+};
+
+util.inherits(RangeStream, Readable);
+
+// Pushes rows of the current batch until the batch is exhausted or the stream is full
+RangeStream.prototype._pushBatch = function() {
+	while(this._batch) {
+		var batch = this._batch;
+		var index = this._index++;
+		if(this._index === batch.length)
+			this._batch = undefined;
+
+		if(!this.push(this._objectMode ? rowAt(batch, index) : valueAt(batch, index)))
+			return false;
+	}
+
+	return true;
+};
+
+RangeStream.prototype._read = function() {
+	if(!this._pushBatch() || this._reading)
+		return;
+
+	this._reading = true;
+
+	var stream = this;
+	this._readBatch(function(err, batch) {
+		stream._reading = false;
+
+		if(err)
+			stream.emit('error', err);
+		else if(!batch)
+			stream.push(null);
+		else {
+			stream._batch = batch;
+			stream._index = 0;
+			stream._read();
+		}
+	});
+};
+
+module.exports = RangeStream;
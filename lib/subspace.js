@@ -44,8 +44,7 @@ Subspace.prototype.key = function() {
 };
 
 Subspace.prototype.pack = function(arr) {
-	var packed = tuple.pack(arr);
-	return Buffer.concat([this.rawPrefix, packed], this.rawPrefix.length + packed.length) ;
+	return tuple.packWithPrefix(this.rawPrefix, arr);
 };
 
 Subspace.prototype.unpack = function(key) {
@@ -53,23 +52,23 @@ Subspace.prototype.unpack = function(key) {
 	if(!this.contains(key))
 		throw new Error('Cannot unpack key that is not in subspace.');
 
-	return tuple.unpack(key.slice(this.rawPrefix.length));
+	return tuple.unpackFrom(key, this.rawPrefix.length);
 };
 
 Subspace.prototype.range = function(arr) {
 	if(typeof arr === 'undefined')
 		arr = [];
 
-	var range = tuple.range(arr);
-	return { 
-		begin: Buffer.concat([this.rawPrefix, range.begin], this.rawPrefix.length + range.begin.length),
-		end: Buffer.concat([this.rawPrefix, range.end], this.rawPrefix.length + range.end.length)
-	};
+	return tuple.rangeWithPrefix(this.rawPrefix, arr);
 };
 
 Subspace.prototype.contains = function(key) {
-	key = fdbUtil.keyToBuffer(key);
-	return key.length >= this.rawPrefix.length && fdbUtil.buffersEqual(key.slice(0, this.rawPrefix.length), this.rawPrefix);
+	return fdbUtil.startsWith(fdbUtil.keyToBuffer(key), this.rawPrefix);
+};
+
+// Returns a KeyBuilder for packing many keys of this subspace without allocating a buffer for each
+Subspace.prototype.keyBuilder = function(initialSize) {
+	return new KeyBuilder(this.rawPrefix, initialSize);
 };
 
 Subspace.prototype.get = function(item) {
@@ -84,4 +83,42 @@ Subspace.prototype.asFoundationDBKey = function() {
 	return this.key();
 };
 
+/*
+ * Packs keys of a subspace into a scratch buffer that already holds the subspace's
+ * prefix. The key returned by pack is a view of the scratch buffer, so it is only
+ * valid until the next call to pack; packInto writes to a buffer supplied by the caller.
+ */
+var KeyBuilder = function(prefix, initialSize) {
+	this.prefix = prefix;
+	this.scratch = new Buffer(Math.max(initialSize || 256, prefix.length));
+	prefix.copy(this.scratch, 0);
+};
+
+KeyBuilder.prototype.pack = function(arr) {
+	var length = tuple.packInto(arr, this.scratch, this.prefix.length);
+	while(length < 0) {
+		this.scratch = new Buffer(this.scratch.length * 2);
+		this.prefix.copy(this.scratch, 0);
+		length = tuple.packInto(arr, this.scratch, this.prefix.length);
+	}
+
+	return this.scratch.slice(0, this.prefix.length + length);
+};
+
+// Writes the key to target at offset (default 0). Returns the length of the key, or -1 if it does not fit.
+KeyBuilder.prototype.packInto = function(arr, target, offset) {
+	offset = offset || 0;
+	if(offset + this.prefix.length > target.length)
+		return -1;
+
+	var length = tuple.packInto(arr, target, offset + this.prefix.length);
+	if(length < 0)
+		return -1;
+
+	this.prefix.copy(target, offset);
+	return this.prefix.length + length;
+};
+
+Subspace.KeyBuilder = KeyBuilder;
+
 module.exports = Subspace;
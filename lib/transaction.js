@@ -30,22 +30,63 @@ var buffer = require('./bufferConversion');
 var FDBError = require('./error');
 var fdb = require('./fdbModule');
 var fdbUtil = require('./fdbUtil');
+var MutationBuilder = require('./mutationBuilder');
 
 function addReadOperations(object, snapshot) {
 	object.prototype.get = function(key, cb) {
 		var tr = this.tr;
-		key = fdbUtil.keyToBuffer(key);
-	
+		key = fdbUtil.keyToNative(key);
+
+		// With a callback, skip allocating the closure that future.create would be given
+		if(cb) {
+			tr.get(key, snapshot, cb);
+			return;
+		}
+
 		return future.create(function(futureCb) {
 			tr.get(key, snapshot, futureCb);
-		}, cb);
+		});
+	};
+
+	object.prototype.getMany = function(keys, cb) {
+		if(!(keys instanceof Array))
+			throw new TypeError('getMany must be called with an array of keys');
+
+		var tr = this.tr;
+		var nativeKeys = new Array(keys.length);
+		for(var i = 0; i < keys.length; ++i)
+			nativeKeys[i] = fdbUtil.keyToNative(keys[i]);
+
+		// There is nothing to wait for, but the callback must still not be called before getMany returns
+		if(nativeKeys.length === 0) {
+			if(cb) {
+				process.nextTick(function() { cb(undefined, []); });
+				return;
+			}
+
+			return future.resolve([]);
+		}
+
+		if(cb) {
+			tr.getMany(nativeKeys, snapshot, cb);
+			return;
+		}
+
+		return future.create(function(futureCb) {
+			tr.getMany(nativeKeys, snapshot, futureCb);
+		});
 	};
 
 	object.prototype.getKey = function(keySelector, cb) {
 		var tr = this.tr;
+		if(cb) {
+			tr.getKey(keySelector.key, keySelector.orEqual, keySelector.offset, snapshot, cb);
+			return;
+		}
+
 		return future.create(function(futureCb) {
 			tr.getKey(keySelector.key, keySelector.orEqual, keySelector.offset, snapshot, futureCb);
-		}, cb);
+		});
 	};
 
 	object.prototype.getRange = function(start, end, options) {
@@ -54,6 +95,9 @@ function addReadOperations(object, snapshot) {
 		if(!KeySelector.isKeySelector(end))
 			end = KeySelector.firstGreaterOrEqual(end);
 
+		// The iterator can outlive doTransaction's callback, so the transaction must not be pooled
+		(snapshot ? this._transaction : this)._rangeRead = true;
+
 		return rangeIterator(this.tr, start, end, options, snapshot);
 	};
 
@@ -64,29 +108,53 @@ function addReadOperations(object, snapshot) {
 
 	object.prototype.getReadVersion = function(cb) {
 		var tr = this.tr;
+		if(cb) {
+			tr.getReadVersion(cb, snapshot);
+			return;
+		}
+
 		return future.create(function(futureCb) {
 			tr.getReadVersion(futureCb, snapshot);
-		}, cb);
+		});
 	};
 }
 
-var atomic = function(tr, op) {
-	return function(key, value) { fdb.atomic[op].call(tr, fdbUtil.keyToBuffer(key), fdbUtil.valueToBuffer(value)); };
+var atomic = function(op) {
+	return function(key, value) {
+		this._needsCommit = true;
+		fdb.atomic[op].call(this.tr, fdbUtil.keyToNative(key), fdbUtil.valueToNative(value));
+	};
 };
 
 var Transaction = function(db, tr) {
 	this.db = db;
 	this.tr = tr;
 
-	this.options = tr.options;
-	this.snapshot = new Transaction.SnapshotTransaction(tr);
+	this._snapshot = undefined;
+	this._watched = false;
+	this._rangeRead = false;
 
-	for(var op in fdb.atomic)
-		this[op] = atomic(tr, op);
+	// Set by anything that only takes effect when committed, so read-only transactions can skip the commit
+	this._needsCommit = false;
 };
 
-Transaction.SnapshotTransaction = function(tr) { 
-	this.tr = tr;
+// The options and snapshot views are created on first use, since most transactions need neither
+Object.defineProperty(Transaction.prototype, 'options', {
+	get: function() { return this.tr.options; }
+});
+
+Object.defineProperty(Transaction.prototype, 'snapshot', {
+	get: function() {
+		if(!this._snapshot)
+			this._snapshot = new Transaction.SnapshotTransaction(this);
+
+		return this._snapshot;
+	}
+});
+
+Transaction.SnapshotTransaction = function(transaction) { 
+	this.tr = transaction.tr;
+	this._transaction = transaction;
 };
 
 addReadOperations(Transaction, false);
@@ -100,34 +168,48 @@ Transaction.prototype.doTransaction = function(func, cb) {
 };
 
 Transaction.prototype.set = function(key, value) {
-	key = fdbUtil.keyToBuffer(key);
-	value = fdbUtil.valueToBuffer(value);
+	key = fdbUtil.keyToNative(key);
+	value = fdbUtil.valueToNative(value);
 
+	this._needsCommit = true;
 	this.tr.set(key, value);
 };
 
 Transaction.prototype.clear = function(key) {
-	key = fdbUtil.keyToBuffer(key);
+	key = fdbUtil.keyToNative(key);
 
+	this._needsCommit = true;
 	this.tr.clear(key);
 };
 
 Transaction.prototype.clearRange = function(start, end) {
-	start = fdbUtil.keyToBuffer(start);
-	end = fdbUtil.keyToBuffer(end);
+	start = fdbUtil.keyToNative(start);
+	end = fdbUtil.keyToNative(end);
 
+	this._needsCommit = true;
 	this.tr.clearRange(start, end);
 };
 
+// Applies the mutations encoded by a MutationBuilder (or a buffer in the same format) in one native call
+Transaction.prototype.applyMutations = function(mutations) {
+	this._needsCommit = true;
+	if(mutations instanceof MutationBuilder)
+		this.tr.applyMutations(mutations.buffer, mutations.length);
+	else
+		this.tr.applyMutations(fdbUtil.valueToBuffer(mutations));
+};
+
 Transaction.prototype.clearRangeStartsWith = function(prefix) {
 	prefix = fdbUtil.keyToBuffer(prefix);
 	this.clearRange(prefix, fdbUtil.strinc(prefix));
 };
 
 Transaction.prototype.watch = function(key) {
-	key = fdbUtil.keyToBuffer(key);
+	key = fdbUtil.keyToNative(key);
 
 	var self = this;
+	this._watched = true;
+	this._needsCommit = true;
 	var watchFuture = future.create(function(futureCb) {
 		// 'this' is the future that is being created.
 		// We set its cancel method to cancel the watch.
@@ -139,8 +221,8 @@ Transaction.prototype.watch = function(key) {
 };
 
 Transaction.prototype.addReadConflictRange = function(start, end) {
-	start = fdbUtil.keyToBuffer(start);
-	end = fdbUtil.keyToBuffer(end);
+	start = fdbUtil.keyToNative(start);
+	end = fdbUtil.keyToNative(end);
 	this.tr.addReadConflictRange(start, end);
 };
 
@@ -150,36 +232,53 @@ Transaction.prototype.addReadConflictKey = function(key) {
 };
 
 Transaction.prototype.addWriteConflictRange = function(start, end) {
-	start = fdbUtil.keyToBuffer(start);
-	end = fdbUtil.keyToBuffer(end);
+	start = fdbUtil.keyToNative(start);
+	end = fdbUtil.keyToNative(end);
 
+	this._needsCommit = true;
 	this.tr.addWriteConflictRange(start, end);
 };
 
 Transaction.prototype.addWriteConflictKey = function(key) {
 	key = fdbUtil.keyToBuffer(key);
+	this._needsCommit = true;
 	this.tr.addWriteConflictRange(key, Buffer.concat([key, buffer.fromByteLiteral('\x00')], key.length + 1));
 };
 
 Transaction.prototype.commit = function(cb) {
 	var tr = this.tr;
+	if(cb) {
+		tr.commit(cb);
+		return;
+	}
+
 	return future.create(function(futureCb) {
 		tr.commit(futureCb);
-	}, cb);
+	});
 };
 
 Transaction.prototype.onError = function(fdbError, cb) {
+	var self = this;
 	var tr = this.tr;
 	return future.create(function(futureCb) {
-		if(fdbError instanceof FDBError)
-			tr.onError(fdbError.code, futureCb);
-		else
+		if(fdbError instanceof FDBError) {
+			tr.onError(fdbError.code, function(err, res) {
+				// A successful onError resets the transaction
+				if(!err)
+					self._needsCommit = false;
+
+				futureCb(err, res);
+			});
+		}
+		else {
 			futureCb(fdbError, null);
+		}
 	}, cb);
 };
 
 Transaction.prototype.reset = function() {
 	this.tr.reset();
+	this._needsCommit = false;
 };
 
 Transaction.prototype.setReadVersion = function(version) {
@@ -190,9 +289,16 @@ Transaction.prototype.getCommittedVersion = function() {
 	return this.tr.getCommittedVersion();
 };
 
+Transaction.prototype.setZeroCopyResults = function(enable) {
+	this.tr.setZeroCopyResults(!!enable);
+};
+
 Transaction.prototype.cancel = function() {
 	this.tr.cancel();
 };
 
+for(var op in fdb.atomic)
+	Transaction.prototype[op] = atomic(op);
+
 module.exports = Transaction;
 
@@ -27,6 +27,16 @@ var assert = require('assert');
 var buffer = require('./bufferConversion');
 var fdbUtil = require('./fdbUtil');
 
+// The native codec is used when the addon is available; the JavaScript
+// implementation below handles everything it declines (and all errors)
+var nativeTuple;
+try {
+	nativeTuple = require('./fdbModule');
+}
+catch(e) {
+	nativeTuple = undefined;
+}
+
 var sizeLimits = new Array(8);
 
 function setupSizeLimits() {
@@ -147,6 +157,50 @@ function pack(arr) {
 	if(!(arr instanceof Array))
 		throw new TypeError('fdb.tuple.pack must be called with a single array argument');
 
+	if(nativeTuple) {
+		var packed = nativeTuple.tuplePack(arr);
+		if(packed)
+			return packed;
+	}
+
+	return packImpl(arr);
+}
+
+// Returns prefix followed by the packed tuple, in a single buffer
+function packWithPrefix(prefix, arr) {
+	if(!(arr instanceof Array))
+		throw new TypeError('fdb.tuple.pack must be called with a single array argument');
+
+	if(nativeTuple) {
+		var packed = nativeTuple.tuplePack(arr, prefix);
+		if(packed)
+			return packed;
+	}
+
+	packed = packImpl(arr);
+	return Buffer.concat([prefix, packed], prefix.length + packed.length);
+}
+
+// Writes the packed tuple into target at offset. Returns the number of bytes written, or -1 if it does not fit.
+function packInto(arr, target, offset) {
+	if(!(arr instanceof Array))
+		throw new TypeError('fdb.tuple.pack must be called with a single array argument');
+
+	if(nativeTuple) {
+		var length = nativeTuple.tuplePackInto(arr, target, offset);
+		if(typeof length === 'number')
+			return length;
+	}
+
+	var packed = packImpl(arr);
+	if(offset > target.length || packed.length > target.length - offset)
+		return -1;
+
+	packed.copy(target, offset);
+	return packed.length;
+}
+
+function packImpl(arr) {
 	var totalLength = 0;
 
 	var outArr = [];
@@ -236,11 +290,26 @@ function decode(buf, pos) {
 }
 
 function unpack(key) {
-	var res = { pos: 0 };
-	var arr = [];
+	return unpackFrom(key, 0);
+}
 
+// Unpacks the part of key that starts at offset
+function unpackFrom(key, offset) {
 	key = fdbUtil.keyToBuffer(key);
 
+	if(nativeTuple) {
+		var arr = nativeTuple.tupleUnpack(key, offset);
+		if(arr)
+			return arr;
+	}
+
+	return unpackImpl(offset > 0 ? key.slice(offset) : key);
+}
+
+function unpackImpl(key) {
+	var res = { pos: 0 };
+	var arr = [];
+
 	while(res.pos < key.length) {
 		res = decode(key, res.pos);
 		arr.push(res.value);
@@ -250,8 +319,354 @@ function unpack(key) {
 }
 
 function range(arr) {
-	var packed = pack(arr);
+	return rangeWithPrefix(undefined, arr);
+}
+
+// The range of keys that start with prefix (if given) followed by the packed tuple
+function rangeWithPrefix(prefix, arr) {
+	if(nativeTuple && arr instanceof Array) {
+		var res = nativeTuple.tupleRange(arr, prefix);
+		if(res)
+			return res;
+	}
+
+	var packed = prefix ? packWithPrefix(prefix, arr) : pack(arr);
 	return { begin: Buffer.concat([packed, nullByte]), end: Buffer.concat([packed, new Buffer('ff', 'hex')]) };
 }
 
-module.exports = {pack: pack, unpack: unpack, range: range};
+/*
+ * Codecs compiled from a schema, for tuples whose elements always have the same types.
+ * Each element is encoded and decoded by a function specific to its type, straight into
+ * the output buffer or the result, without the per-element dispatch of pack and unpack.
+ */
+
+function schemaMismatch(buf, pos) {
+	return new TypeError('Key does not match tuple schema at position ' + pos + ': ' + buffer.printable(buf));
+}
+
+function intLength(magnitude) {
+	var length = 0;
+	while(length < sizeLimits.length && magnitude > sizeLimits[length])
+		++length;
+
+	return length;
+}
+
+function checkInt(item) {
+	if(typeof item !== 'number' || item % 1 !== 0)
+		throw new TypeError('Tuple schema expected an integer, got ' + item);
+	if(item > maxInt || item < minInt)
+		throw new RangeError('Cannot pack signed integer larger than 54 bits');
+}
+
+function countNullChars(str) {
+	var count = 0;
+	for(var i = str.indexOf('\u0000'); i >= 0; i = str.indexOf('\u0000', i + 1))
+		++count;
+
+	return count;
+}
+
+function writeEscapedBytes(item, code, buf, pos) {
+	buf[pos++] = code;
+	for(var i = 0; i < item.length; ++i) {
+		buf[pos++] = item[i];
+		if(item[i] === 0)
+			buf[pos++] = 0xff;
+	}
+
+	buf[pos++] = 0;
+	return pos;
+}
+
+// Strings up to this length are encoded and decoded without calling into the Buffer implementation
+var SHORT_STRING_LENGTH = 32;
+
+// Set by the field readers to the position after the element they read
+var readPos = 0;
+
+var fieldTypes = {
+	string: {
+		size: function(item) {
+			if(typeof item !== 'string')
+				throw new TypeError('Tuple schema expected a string, got ' + item);
+
+			if(item.length <= SHORT_STRING_LENGTH) {
+				var nulls = 0;
+				for(var i = 0; i < item.length; ++i) {
+					var c = item.charCodeAt(i);
+					if(c >= 0x80)
+						break;
+					if(c === 0)
+						++nulls;
+				}
+
+				if(i === item.length)
+					return item.length + nulls + 2;
+			}
+
+			return Buffer.byteLength(item, 'utf8') + countNullChars(item) + 2;
+		},
+		write: function(item, buf, pos) {
+			// Short ASCII strings are copied here, which is much cheaper than a call to buf.write
+			if(item.length <= SHORT_STRING_LENGTH) {
+				var p = pos;
+				buf[p++] = 2;
+				for(var i = 0; i < item.length; ++i) {
+					var c = item.charCodeAt(i);
+					if(c >= 0x80)
+						break;
+
+					buf[p++] = c;
+					if(c === 0)
+						buf[p++] = 0xff;
+				}
+
+				if(i === item.length) {
+					buf[p++] = 0;
+					return p;
+				}
+			}
+
+			if(item.indexOf('\u0000') >= 0)
+				return writeEscapedBytes(new Buffer(item, 'utf8'), 2, buf, pos);
+
+			buf[pos] = 2;
+			pos += 1 + buf.write(item, pos + 1, 'utf8');
+			buf[pos++] = 0;
+			return pos;
+		},
+		read: function(buf, pos) {
+			if(buf[pos] !== 2)
+				throw schemaMismatch(buf, pos);
+
+			var end = pos + 1;
+			var ascii = true;
+			while(end < buf.length && buf[end] !== 0) {
+				if(buf[end] >= 0x80)
+					ascii = false;
+				++end;
+			}
+
+			// Strings with escaped null bytes are rare enough to leave to the generic decoder
+			if(end + 1 < buf.length && buf[end + 1] === 0xff) {
+				var res = decode(buf, pos);
+				readPos = res.pos;
+				return res.value;
+			}
+
+			readPos = end + 1;
+			if(ascii && end - pos <= SHORT_STRING_LENGTH) {
+				var str = '';
+				for(var i = pos + 1; i < end; ++i)
+					str += String.fromCharCode(buf[i]);
+
+				return str;
+			}
+
+			return buf.toString('utf8', pos + 1, end);
+		}
+	},
+
+	// Items are converted to Buffers once, by convert, before they are sized and written
+	bytes: {
+		convert: function(item) {
+			return buffer(item);
+		},
+		size: function(item) {
+			var size = item.length + 2;
+			for(var i = 0; i < item.length; ++i)
+				if(item[i] === 0)
+					++size;
+
+			return size;
+		},
+		write: function(item, buf, pos) {
+			return writeEscapedBytes(item, 1, buf, pos);
+		},
+		read: function(buf, pos) {
+			if(buf[pos] !== 1)
+				throw schemaMismatch(buf, pos);
+
+			var res = decode(buf, pos);
+			readPos = res.pos;
+			return res.value;
+		}
+	},
+
+	int: {
+		size: function(item) {
+			checkInt(item);
+			return intLength(Math.abs(item)) + 1;
+		},
+		write: function(item, buf, pos) {
+			var negative = item < 0;
+			var magnitude = Math.abs(item);
+			var length = intLength(magnitude);
+
+			buf[pos] = negative ? 20 - length : 20 + length;
+			for(var byteIdx = length; byteIdx > 0; --byteIdx) {
+				var b = magnitude % 0x100;
+				buf[pos + byteIdx] = negative ? ~b : b;
+				magnitude = (magnitude - b) / 0x100;
+			}
+
+			return pos + length + 1;
+		},
+		read: function(buf, pos) {
+			var bytes = buf[pos] - 20;
+			if(!(bytes >= -8 && bytes <= 8))
+				throw schemaMismatch(buf, pos);
+
+			// 8 byte integers are well-formed, but out of range just as for unpack
+			if(bytes === 8 || bytes === -8)
+				throw new RangeError('Cannot unpack signed integers larger than 54 bits');
+
+			if(pos + Math.abs(bytes) >= buf.length)
+				throw schemaMismatch(buf, pos);
+
+			readPos = pos + Math.abs(bytes) + 1;
+			return bytes === 0 ? 0 : decodeNumber(buf, pos + 1, bytes);
+		}
+	}
+};
+
+/*
+ * schema is an array with an entry for each element of the tuple: either a type ('string',
+ * 'bytes' or 'int'), or { name: <field name>, type: <type> }. If the elements are named, tuples
+ * are passed to pack and returned by unpack as objects with those fields; otherwise as arrays.
+ */
+var TupleCodec = function(schema) {
+	if(!(schema instanceof Array))
+		throw new TypeError('fdb.tuple.compile must be called with an array');
+
+	this.length = schema.length;
+	this.names = undefined;
+	this.items = new Array(schema.length);
+	this.converters = new Array(schema.length);
+	this.sizers = new Array(schema.length);
+	this.writers = new Array(schema.length);
+	this.readers = new Array(schema.length);
+
+	for(var i = 0; i < schema.length; ++i) {
+		var field = typeof schema[i] === 'string' ? { type: schema[i] } : schema[i];
+		var fieldType = field && fieldTypes.hasOwnProperty(field.type) ? fieldTypes[field.type] : undefined;
+		if(!fieldType)
+			throw new TypeError('Unknown tuple schema type: ' + (field && field.type));
+
+		var named = typeof field.name === 'string';
+		if(i === 0 && named)
+			this.names = new Array(schema.length);
+		else if(named !== !!this.names)
+			throw new TypeError('Either all or none of the elements of a tuple schema must be named');
+		if(this.names)
+			this.names[i] = field.name;
+
+		this.converters[i] = fieldType.convert;
+		this.sizers[i] = fieldType.size;
+		this.writers[i] = fieldType.write;
+		this.readers[i] = fieldType.read;
+	}
+};
+
+// Gathers the elements of values into this.items, converted where their type needs it
+TupleCodec.prototype.prepare = function(values) {
+	var items = this.items;
+	for(var i = 0; i < this.length; ++i) {
+		var item = this.names ? values[this.names[i]] : values[i];
+		items[i] = this.converters[i] ? this.converters[i](item) : item;
+	}
+
+	return items;
+};
+
+// Drops the references to the last tuple packed
+TupleCodec.prototype.release = function() {
+	for(var i = 0; i < this.length; ++i)
+		this.items[i] = undefined;
+};
+
+TupleCodec.prototype.size = function(items) {
+	var size = 0;
+	for(var i = 0; i < this.length; ++i)
+		size += this.sizers[i](items[i]);
+
+	return size;
+};
+
+TupleCodec.prototype.write = function(items, buf, pos) {
+	for(var i = 0; i < this.length; ++i)
+		pos = this.writers[i](items[i], buf, pos);
+
+	return pos;
+};
+
+// Returns the packed tuple, after prefix if one is given, in a single buffer
+TupleCodec.prototype.pack = function(values, prefix) {
+	var items = this.prepare(values);
+
+	var prefixLength = prefix ? prefix.length : 0;
+	var buf = new Buffer(prefixLength + this.size(items));
+	if(prefix)
+		prefix.copy(buf, 0);
+
+	this.write(items, buf, prefixLength);
+	this.release();
+	return buf;
+};
+
+// Writes the packed tuple into target at offset. Returns the number of bytes written, or -1 if it does not fit.
+TupleCodec.prototype.packInto = function(values, target, offset) {
+	offset = offset || 0;
+
+	var items = this.prepare(values);
+	var size = this.size(items);
+	if(offset + size > target.length) {
+		this.release();
+		return -1;
+	}
+
+	this.write(items, target, offset);
+	this.release();
+	return size;
+};
+
+// Decodes the tuple starting at offset (default 0) of key, which must match the schema exactly
+TupleCodec.prototype.unpack = function(key, offset) {
+	key = fdbUtil.keyToBuffer(key);
+
+	var pos = offset || 0;
+	var result = this.names ? {} : new Array(this.length);
+	for(var i = 0; i < this.length; ++i) {
+		if(pos >= key.length)
+			throw schemaMismatch(key, pos);
+
+		var value = this.readers[i](key, pos);
+		pos = readPos;
+
+		if(this.names)
+			result[this.names[i]] = value;
+		else
+			result[i] = value;
+	}
+
+	if(pos < key.length)
+		throw schemaMismatch(key, pos);
+
+	return result;
+};
+
+function compile(schema) {
+	return new TupleCodec(schema);
+}
+
+module.exports = {
+	pack: pack,
+	unpack: unpack,
+	range: range,
+	packWithPrefix: packWithPrefix,
+	packInto: packInto,
+	unpackFrom: unpackFrom,
+	rangeWithPrefix: rangeWithPrefix,
+	compile: compile
+};
@@ -0,0 +1,251 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var future = require('./future');
+var fdbUtil = require('./fdbUtil');
+var Subspace = require('./subspace');
+
+var DEFAULT_MAX_ENTRIES = 1000;
+
+/*
+ * A bounded LRU cache of the values of keys in a subspace. Each entry holds a watch
+ * on its key and is dropped as soon as the watch fires. Entries also record the
+ * read version their value was read at, and a transaction is only served an entry
+ * read at exactly its own read version.
+ *
+ * Every entry uses one watch, so maxEntries should stay below the database's
+ * limit on outstanding watches.
+ */
+var ValueCache = function(db, subspace, options) {
+	options = options || {};
+
+	this.db = db;
+	this.subspace = subspace || new Subspace();
+	this.maxEntries = options.maxEntries || DEFAULT_MAX_ENTRIES;
+	this.maxBytes = options.maxBytes || 0;
+
+	this.size = 0;
+	this.bytes = 0;
+
+	this._entries = {};
+	this._pending = {};
+
+	// Sentinel of a circular list ordered from most to least recently used
+	this._lru = { prev: null, next: null };
+	this._lru.prev = this._lru;
+	this._lru.next = this._lru;
+};
+
+// Keys are tuples in the subspace, or complete keys that must lie within it
+function cacheKey(cache, key) {
+	if(key instanceof Array)
+		return cache.subspace.pack(key);
+
+	key = fdbUtil.keyToBuffer(key);
+	if(!cache.subspace.contains(key))
+		throw new Error('Cannot cache key that is not in subspace.');
+
+	return key;
+}
+
+function entryBytes(key, value) {
+	return key.length + (value ? value.length : 0);
+}
+
+function unlink(entry) {
+	entry.prev.next = entry.next;
+	entry.next.prev = entry.prev;
+}
+
+function linkFront(cache, entry) {
+	entry.prev = cache._lru;
+	entry.next = cache._lru.next;
+	cache._lru.next.prev = entry;
+	cache._lru.next = entry;
+}
+
+function touch(cache, entry) {
+	unlink(entry);
+	linkFront(cache, entry);
+}
+
+function remove(cache, entry) {
+	entry.invalid = true;
+	if(cache._entries[entry.id] !== entry)
+		return;
+
+	delete cache._entries[entry.id];
+	unlink(entry);
+	cache.size--;
+	cache.bytes -= entry.bytes;
+
+	entry.watch.cancel();
+}
+
+function insert(cache, entry) {
+	var existing = cache._entries[entry.id];
+	if(existing)
+		remove(cache, existing);
+
+	cache._entries[entry.id] = entry;
+	linkFront(cache, entry);
+	cache.size++;
+	cache.bytes += entry.bytes;
+
+	while(cache.size > cache.maxEntries || (cache.maxBytes && cache.bytes > cache.maxBytes && cache.size > 1))
+		remove(cache, cache._lru.prev);
+}
+
+/*
+ * Reads key and sets a watch on it in one transaction, then caches the value.
+ * Concurrent misses on the same key share a single read.
+ */
+function fill(cache, key, id, cb) {
+	var waiting = cache._pending[id];
+	if(waiting) {
+		waiting.push(cb);
+		return;
+	}
+
+	waiting = [cb];
+	cache._pending[id] = waiting;
+
+	var entry = { id: id, key: key, value: undefined, version: 0, bytes: 0, watch: undefined, invalid: false, prev: null, next: null };
+
+	cache.db.doTransaction(function(tr, innerCb) {
+		tr.get(key, function(err, value) {
+			if(err)
+				return innerCb(err);
+
+			tr.getReadVersion(function(err, version) {
+				if(err)
+					return innerCb(err);
+
+				entry.value = value;
+				entry.version = version;
+				entry.bytes = entryBytes(key, value);
+
+				// A watch from an attempt that was retried fails, but no longer belongs to the entry
+				var watch = tr.watch(key);
+				entry.watch = watch;
+				watch(function() {
+					if(entry.watch === watch)
+						remove(cache, entry);
+				});
+
+				innerCb();
+			});
+		});
+	}, function(err) {
+		delete cache._pending[id];
+
+		if(!err && !entry.invalid)
+			insert(cache, entry);
+
+		for(var i = 0; i < waiting.length; ++i) {
+			if(err)
+				waiting[i](err);
+			else
+				waiting[i](undefined, entry.value);
+		}
+	});
+}
+
+// Returns the cached value of key, reading it from the database on a miss
+ValueCache.prototype.get = function(key, cb) {
+	var cache = this;
+	key = cacheKey(this, key);
+
+	return future.create(function(futureCb) {
+		var id = key.toString('binary');
+		var entry = cache._entries[id];
+		if(entry) {
+			touch(cache, entry);
+			futureCb(undefined, entry.value);
+		}
+		else {
+			fill(cache, key, id, futureCb);
+		}
+	}, cb);
+};
+
+/*
+ * Reads key as part of tr. The cached value is only used if it was read at tr's read
+ * version, in which case a read conflict on key is added just as a read would. A value
+ * read at a later version may not be in tr's snapshot, and read-only transactions are
+ * never committed, so the conflict would not catch it. Transactions that share read
+ * versions (see Database.setReadVersionCache) therefore hit the cache; others read
+ * through and move the entry to their read version if the value is unchanged.
+ */
+ValueCache.prototype.getInTransaction = function(tr, key, cb) {
+	var cache = this;
+	key = cacheKey(this, key);
+
+	return future.create(function(futureCb) {
+		// The cache cannot reflect the transaction's own writes
+		if(tr._needsCommit)
+			return tr.get(key, futureCb);
+
+		var id = key.toString('binary');
+		tr.getReadVersion(function(err, readVersion) {
+			if(err)
+				return futureCb(err);
+
+			var entry = cache._entries[id];
+			if(entry && entry.version === readVersion) {
+				touch(cache, entry);
+				tr.addReadConflictKey(key);
+				futureCb(undefined, entry.value);
+			}
+			else {
+				tr.get(key, function(err, value) {
+					if(!err) {
+						if(!entry)
+							fill(cache, key, id, function() {});
+						// A changed value is left for the entry's watch to invalidate
+						else if(cache._entries[id] === entry && !tr._needsCommit && readVersion > entry.version && fdbUtil.buffersEqual(entry.value, value))
+							entry.version = readVersion;
+					}
+
+					futureCb(err, value);
+				});
+			}
+		});
+	}, cb);
+};
+
+ValueCache.prototype.invalidate = function(key) {
+	var entry = this._entries[cacheKey(this, key).toString('binary')];
+	if(entry)
+		remove(this, entry);
+};
+
+// Drops every entry and cancels their watches
+ValueCache.prototype.clear = function() {
+	while(this._lru.next !== this._lru)
+		remove(this, this._lru.next);
+};
+
+module.exports = ValueCache;
@@ -0,0 +1,182 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+var future = require('./future');
+var MutationBuilder = require('./mutationBuilder');
+
+var DEFAULT_MAX_OPS = 1000;
+var DEFAULT_MAX_BYTES = 1000000;
+
+// Writes larger than this are committed on their own, so that an oversized key or value only fails its own caller
+var MAX_BATCHED_WRITE_BYTES = 10000;
+
+// Errors caused by the content of a write (key_outside_legal_range, inverted_range,
+// transaction_too_large, key_too_large and value_too_large) rather than by the cluster
+var WRITE_ERROR_CODES = [2004, 2005, 2101, 2102, 2103];
+
+/*
+ * Collects blind writes issued through a Database and commits them together in
+ * shared transactions. A batch is committed once it holds maxOps writes or
+ * maxBytes of encoded mutations, or maxDelay milliseconds after its first write
+ * (with the default maxDelay of 0, at the end of the current turn of the event
+ * loop). Every caller's callback receives the outcome of the batch it was part of,
+ * except when the batch is rejected because of the content of its writes. Each of its
+ * writes is then committed on its own, so that only the callers of the writes at
+ * fault receive the error.
+ *
+ * Writes in a batch are applied in the order they were issued, but a write is only
+ * durable once its own callback has been called.
+ */
+var WriteBatcher = function(db, options) {
+	options = options || {};
+
+	this.db = db;
+	this.maxOps = options.maxOps || DEFAULT_MAX_OPS;
+	this.maxBytes = options.maxBytes || DEFAULT_MAX_BYTES;
+	this.maxDelay = options.maxDelay || 0;
+
+	this.builder = new MutationBuilder();
+	this.callbacks = [];
+	this.offsets = [];
+	this.timer = undefined;
+};
+
+// Writes to system keys are also left to their own transactions, since they fail unless the database allows them
+WriteBatcher.prototype.accepts = function(key, value) {
+	return key[0] !== 0xff && key.length + (value ? value.length : 0) <= MAX_BATCHED_WRITE_BYTES;
+};
+
+WriteBatcher.prototype.supportsAtomic = function(op) {
+	return MutationBuilder.isAtomicOp(op);
+};
+
+// offset is where the write's record starts in the batch's mutation log
+function enqueue(batcher, offset, cb) {
+	batcher.callbacks.push(cb);
+	batcher.offsets.push(offset);
+
+	if(batcher.callbacks.length >= batcher.maxOps || batcher.builder.length >= batcher.maxBytes)
+		batcher.flush();
+	else if(!batcher.timer) {
+		if(batcher.maxDelay)
+			batcher.timer = setTimeout(function() { batcher.flush(); }, batcher.maxDelay);
+		else
+			batcher.timer = setImmediate(function() { batcher.flush(); });
+	}
+}
+
+WriteBatcher.prototype.set = function(key, value, cb) {
+	var batcher = this;
+	return future.create(function(futureCb) {
+		var offset = batcher.builder.length;
+		batcher.builder.set(key, value);
+		enqueue(batcher, offset, futureCb);
+	}, cb);
+};
+
+WriteBatcher.prototype.clear = function(key, cb) {
+	var batcher = this;
+	return future.create(function(futureCb) {
+		var offset = batcher.builder.length;
+		batcher.builder.clear(key);
+		enqueue(batcher, offset, futureCb);
+	}, cb);
+};
+
+WriteBatcher.prototype.clearRange = function(start, end, cb) {
+	var batcher = this;
+	return future.create(function(futureCb) {
+		var offset = batcher.builder.length;
+		batcher.builder.clearRange(start, end);
+		enqueue(batcher, offset, futureCb);
+	}, cb);
+};
+
+WriteBatcher.prototype.atomicOp = function(op, key, param, cb) {
+	var batcher = this;
+	return future.create(function(futureCb) {
+		var offset = batcher.builder.length;
+		batcher.builder.atomicOp(op, key, param);
+		enqueue(batcher, offset, futureCb);
+	}, cb);
+};
+
+// Commits the writes collected so far. Writes issued meanwhile start a new batch.
+WriteBatcher.prototype.flush = function() {
+	if(this.timer) {
+		if(this.maxDelay)
+			clearTimeout(this.timer);
+		else
+			clearImmediate(this.timer);
+
+		this.timer = undefined;
+	}
+
+	if(this.callbacks.length === 0)
+		return;
+
+	var db = this.db;
+	var mutations = this.builder;
+	var callbacks = this.callbacks;
+	var offsets = this.offsets;
+
+	this.builder = new MutationBuilder(mutations.buffer.length);
+	this.callbacks = [];
+	this.offsets = [];
+
+	db.doTransaction(function(tr, innerCb) {
+		tr.applyMutations(mutations);
+		innerCb();
+	}, function(err) {
+		if(err && callbacks.length > 1 && WRITE_ERROR_CODES.indexOf(err.code) !== -1)
+			commitSeparately(db, mutations, offsets, callbacks);
+		else {
+			for(var i = 0; i < callbacks.length; ++i)
+				callbacks[i](err);
+		}
+	});
+};
+
+// Nothing in a rejected batch was applied, so its writes can be replayed one at a time, in order
+function commitSeparately(db, mutations, offsets, callbacks) {
+	var index = 0;
+	(function next() {
+		if(index === callbacks.length)
+			return;
+
+		var i = index++;
+		var write = mutations.buffer.slice(offsets[i], i + 1 < offsets.length ? offsets[i + 1] : mutations.length);
+
+		db.doTransaction(function(tr, innerCb) {
+			tr.applyMutations(write);
+			innerCb();
+		}, function(err) {
+			callbacks[i](err);
+			next();
+		});
+	})();
+}
+
+module.exports = WriteBatcher;
@@ -31,6 +31,7 @@
 #include "Database.h"
 #include "FdbOptions.h"
 #include "NodeCallback.h"
+#include "V8Cache.h"
 
 using namespace v8;
 using namespace std;
@@ -42,12 +43,48 @@ Cluster::~Cluster() {
 
 Persistent<Function> Cluster::constructor;
 
+struct NodeDatabaseCallback : NodeCallback {
+
+	NodeDatabaseCallback(FDBFuture *future, Handle<Function> cbFunc, Handle<Object> clusterObj) : NodeCallback(future, cbFunc) {
+		cluster.Reset(Isolate::GetCurrent(), clusterObj);
+	}
+
+	virtual ~NodeDatabaseCallback() {
+		cluster.Reset();
+	}
+
+	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) {
+		Isolate *isolate = Isolate::GetCurrent();
+		EscapableHandleScope scope(isolate);
+
+		FDBDatabase *database;
+		outErr = fdb_future_get_database(future, &database);
+		if (outErr) return Undefined(isolate);
+
+		Local<Value> jsValue = Local<Value>::New(isolate, Database::NewInstance(database));
+
+		return scope.Escape(jsValue);
+	}
+
+	// Keeps the cluster from being collected while the database is being opened
+	Persistent<Object> cluster;
+};
+
+/*
+ * Takes a database name and an optional callback. With a callback, the
+ * database is delivered asynchronously; otherwise, this blocks until it is ready.
+ */
 void Cluster::OpenDatabase(const FunctionCallbackInfo<Value>& info) {
 	Cluster *clusterPtr = ObjectWrap::Unwrap<Cluster>(info.Holder());
 
 	std::string dbName = *String::Utf8Value(info[0]->ToString());
 	FDBFuture *f = fdb_cluster_create_database(clusterPtr->cluster, (uint8_t*)dbName.c_str(), (int)strlen(dbName.c_str()));
 
+	if(info[1]->IsFunction()) {
+		(new NodeDatabaseCallback(f, Local<Function>::Cast(info[1]), info.Holder()))->start();
+		return info.GetReturnValue().SetNull();
+	}
+
 	fdb_error_t errorCode = fdb_future_block_until_ready(f);
 
 	FDBDatabase *database;
@@ -89,7 +126,7 @@ Handle<Value> Cluster::NewInstance(FDBCluster *ptr) {
 	Cluster *clusterObj = ObjectWrap::Unwrap<Cluster>(instance);
 	clusterObj->cluster = ptr;
 
-	instance->Set(String::NewFromUtf8(isolate, "options", String::kInternalizedString), FdbOptions::CreateOptions(FdbOptions::ClusterOption, instance));
+	instance->Set(V8Cache::GetString(V8Cache::OPTIONS), FdbOptions::CreateOptions(FdbOptions::ClusterOption, instance));
 
 	return scope.Escape(instance);
 }
@@ -29,6 +29,7 @@
 #include "Database.h"
 #include "FdbOptions.h"
 #include "NodeCallback.h"
+#include "V8Cache.h"
 
 using namespace v8;
 using namespace std;
@@ -80,7 +81,7 @@ Handle<Value> Database::NewInstance(FDBDatabase *ptr) {
 	Database *dbObj = ObjectWrap::Unwrap<Database>(instance);
 	dbObj->db = ptr;
 
-	instance->Set(String::NewFromUtf8(isolate, "options", String::kInternalizedString), FdbOptions::CreateOptions(FdbOptions::DatabaseOption, instance));
+	instance->Set(V8Cache::GetString(V8Cache::OPTIONS), FdbOptions::CreateOptions(FdbOptions::DatabaseOption, instance));
 
 	return scope.Escape(instance);
 }
@@ -29,21 +29,36 @@ using namespace node;
 
 static Persistent<Object> module;
 
+// The FDBError class is assigned to the module from javascript, so it is looked up on first use
+static Persistent<Function> constructor;
+
 void FdbError::Init(Handle<Object> module) {
 	Isolate *isolate = Isolate::GetCurrent();
 	::module.Reset(isolate, module);
 }
 
+static Local<Function> GetConstructor(Isolate *isolate) {
+	if(constructor.IsEmpty()) {
+		Local<Object> moduleObj = Local<Object>::New(isolate, module);
+		Local<Value> constructorVal = moduleObj->Get( String::NewFromUtf8(isolate, "FDBError", String::kInternalizedString) );
+		if (constructorVal.IsEmpty() || !constructorVal->IsFunction())
+			return Local<Function>();
+
+		constructor.Reset(isolate, Local<Function>::Cast(constructorVal));
+	}
+
+	return Local<Function>::New(isolate, constructor);
+}
+
 Handle<Value> FdbError::NewInstance(fdb_error_t code, const char *description) {
 	Isolate *isolate = Isolate::GetCurrent();
 	EscapableHandleScope scope(isolate);
 
-	Local<Object> moduleObj = Local<Object>::New(isolate, module);
-	Local<Value> constructor = moduleObj->Get( String::NewFromUtf8(isolate, "FDBError", String::kInternalizedString) );
+	Local<Function> constructor = GetConstructor(isolate);
 	Local<Object> instance;
-	if (!constructor.IsEmpty() && constructor->IsFunction()) {
+	if (!constructor.IsEmpty()) {
 		Local<Value> constructorArgs[] = { String::NewFromUtf8(isolate, description), Integer::New(isolate, code) };
-		instance = Local<Function>::Cast(constructor)->NewInstance(2, constructorArgs);
+		instance = constructor->NewInstance(2, constructorArgs);
 	} else {
 		// We can't find the (javascript) FDBError class, so construct and throw *something*
 		instance = Exception::Error(String::NewFromUtf8(isolate, "FDBError class not found.  Unable to deliver error."))->ToObject();
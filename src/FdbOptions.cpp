@@ -26,6 +26,7 @@
 #include "Database.h"
 #include "Transaction.h"
 #include "FdbError.h"
+#include "StringParams.h"
 
 #include <algorithm>
 #include <node_buffer.h>
@@ -214,14 +215,12 @@ void SetTransactionOption(const FunctionCallbackInfo<Value>& info) {
 
 void CallAtomicOperation(const FunctionCallbackInfo<Value>& info) {
 	Transaction *tr = ObjectWrap::Unwrap<Transaction>(info.Holder());
-	Parameter key = GetStringParameter(info, 0);
-	Parameter value = GetStringParameter(info, 1);
+	if(info.Length() < 2 || !StringParams::Accepts(info[0]) || !StringParams::Accepts(info[1]))
+		return NanThrowError(FdbError::NewInstance(INVALID_OPTION_VALUE_ERROR_CODE, fdb_get_error(INVALID_OPTION_VALUE_ERROR_CODE)));
 
-	fdb_error_t errorCode = key.errorCode > 0 ? key.errorCode : value.errorCode;
-	if(errorCode > 0)
-		return NanThrowError(FdbError::NewInstance(errorCode, fdb_get_error(errorCode)));
-
-	fdb_transaction_atomic_op(tr->GetTransaction(), key.getValue(), key.getLength(), value.getValue(), value.getLength(), (FDBMutationType)info.Data()->Uint32Value());
+	StringParams key(info[0]);
+	StringParams value(info[1]);
+	fdb_transaction_atomic_op(tr->GetTransaction(), key.str, key.len, value.str, value.len, (FDBMutationType)info.Data()->Uint32Value());
 
 	info.GetReturnValue().SetNull();
 }
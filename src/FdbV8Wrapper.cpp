@@ -34,6 +34,9 @@
 #include "Version.h"
 #include "FdbError.h"
 #include "FdbOptions.h"
+#include "Tuple.h"
+#include "V8Cache.h"
+#include "Stats.h"
 
 uv_thread_t fdbThread;
 
@@ -70,11 +73,39 @@ static void runNetwork() {
 	uv_thread_create(&fdbThread, networkThread, NULL);  // FIXME: Return code?
 }
 
+struct NodeClusterCallback : NodeCallback {
+
+	NodeClusterCallback(FDBFuture *future, Handle<Function> cbFunc) : NodeCallback(future, cbFunc) { }
+
+	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) {
+		Isolate *isolate = Isolate::GetCurrent();
+		EscapableHandleScope scope(isolate);
+
+		FDBCluster *cluster;
+		outErr = fdb_future_get_cluster(future, &cluster);
+		if (outErr) return Undefined(isolate);
+
+		Local<Value> jsValue = Local<Value>::New(isolate, Cluster::NewInstance(cluster));
+
+		return scope.Escape(jsValue);
+	}
+};
+
+/*
+ * Takes a cluster file path and an optional callback. With a callback, the
+ * cluster is delivered asynchronously; otherwise, this blocks until it is ready.
+ */
 void CreateCluster(const FunctionCallbackInfo<Value>& info) {
 	Isolate *isolate = Isolate::GetCurrent();
 	EscapableHandleScope scope(isolate);
 
 	FDBFuture *f = fdb_create_cluster(*String::Utf8Value(info[0]->ToString()));
+
+	if(info[1]->IsFunction()) {
+		(new NodeClusterCallback(f, Local<Function>::Cast(info[1])))->start();
+		return info.GetReturnValue().SetNull();
+	}
+
 	fdb_error_t errorCode = fdb_future_block_until_ready(f);
 
 	FDBCluster *cluster;
@@ -115,17 +146,27 @@ void StopNetwork(const FunctionCallbackInfo<Value>& info) {
 
 void init(Handle<Object> target){
 	Isolate *isolate = Isolate::GetCurrent();
+	V8Cache::Init();
 	FdbError::Init( target );
 	Database::Init();
 	Transaction::Init();
 	Cluster::Init();
 	FdbOptions::Init();
 	Watch::Init();
+	RangeSpec::Init(target);
 
 	target->Set(String::NewFromUtf8(isolate, "apiVersion", String::kInternalizedString), FunctionTemplate::New(isolate, ApiVersion)->GetFunction());
 	target->Set(String::NewFromUtf8(isolate, "createCluster", String::kInternalizedString), FunctionTemplate::New(isolate, CreateCluster)->GetFunction());
 	target->Set(String::NewFromUtf8(isolate, "startNetwork", String::kInternalizedString), FunctionTemplate::New(isolate, StartNetwork)->GetFunction());
 	target->Set(String::NewFromUtf8(isolate, "stopNetwork", String::kInternalizedString), FunctionTemplate::New(isolate, StopNetwork)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "tuplePack", String::kInternalizedString), FunctionTemplate::New(isolate, Tuple::Pack)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "tupleUnpack", String::kInternalizedString), FunctionTemplate::New(isolate, Tuple::Unpack)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "tupleRange", String::kInternalizedString), FunctionTemplate::New(isolate, Tuple::Range)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "tuplePackInto", String::kInternalizedString), FunctionTemplate::New(isolate, Tuple::PackInto)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "startsWith", String::kInternalizedString), FunctionTemplate::New(isolate, Tuple::StartsWith)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "stats", String::kInternalizedString), FunctionTemplate::New(isolate, Stats::Get)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "resetStats", String::kInternalizedString), FunctionTemplate::New(isolate, Stats::Reset)->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "setDeliveryBudget", String::kInternalizedString), FunctionTemplate::New(isolate, CompletionQueue::SetDeliveryBudget)->GetFunction());
 	target->Set(String::NewFromUtf8(isolate, "options", String::kInternalizedString), FdbOptions::CreateOptions(FdbOptions::NetworkOption));
 	target->Set(String::NewFromUtf8(isolate, "streamingMode", String::kInternalizedString), FdbOptions::CreateEnum(FdbOptions::StreamingMode));
 	target->Set(String::NewFromUtf8(isolate, "atomic", String::kInternalizedString), FdbOptions::CreateOptions(FdbOptions::MutationType));
@@ -0,0 +1,200 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <node.h>
+#include <uv.h>
+#include <climits>
+
+#include "NodeCallback.h"
+
+using namespace v8;
+using namespace std;
+
+std::atomic<NodeCallback*> CompletionQueue::head(NULL);
+uv_async_t CompletionQueue::handle;
+bool CompletionQueue::initialized = false;
+int CompletionQueue::outstanding = 0;
+
+NodeCallback *CompletionQueue::pendingHead[CompletionQueue::PRIORITY_COUNT];
+NodeCallback *CompletionQueue::pendingTail[CompletionQueue::PRIORITY_COUNT];
+
+int CompletionQueue::maxCount = 0;
+uint64_t CompletionQueue::maxTime = 0;
+bool CompletionQueue::prioritizeCommits = false;
+
+void CompletionQueue::init() {
+	uv_async_init(uv_default_loop(), &handle, &CompletionQueue::asyncCallback);
+	uv_unref((uv_handle_t*)&handle);
+	initialized = true;
+}
+
+// May be called from the network thread, or from the node thread if the future was already ready
+void CompletionQueue::push(NodeCallback *nc) {
+	NodeCallback *oldHead = head.load(std::memory_order_relaxed);
+	do {
+		nc->next = oldHead;
+	} while(!head.compare_exchange_weak(oldHead, nc, std::memory_order_release, std::memory_order_relaxed));
+
+	uv_async_send(&handle);
+}
+
+void CompletionQueue::retain() {
+	if(!initialized)
+		init();
+
+	if(outstanding++ == 0)
+		uv_ref((uv_handle_t*)&handle);
+}
+
+void CompletionQueue::release() {
+	if(--outstanding == 0)
+		uv_unref((uv_handle_t*)&handle);
+}
+
+void CompletionQueue::setBudget(int maxCount, uint64_t maxTime, bool prioritizeCommits) {
+	CompletionQueue::maxCount = maxCount;
+	CompletionQueue::maxTime = maxTime;
+	CompletionQueue::prioritizeCommits = prioritizeCommits;
+}
+
+void CompletionQueue::SetDeliveryBudget(const FunctionCallbackInfo<Value>& info) {
+	double maxTimeMicros = info[1]->NumberValue();
+	// Clamped rather than converted with Int32Value, which would wrap large counts negative
+	double maxCount = info[0]->NumberValue();
+	setBudget(maxCount >= INT_MAX ? INT_MAX : (maxCount > 0 ? (int)maxCount : 0), maxTimeMicros > 0 ? (uint64_t)(maxTimeMicros * 1000) : 0, info[2]->BooleanValue());
+
+	info.GetReturnValue().SetNull();
+}
+
+void CompletionQueue::enqueue(NodeCallback *nc) {
+	int priority = prioritizeCommits && nc->operation == Stats::COMMIT ? HIGH : NORMAL;
+
+	nc->next = NULL;
+	if(pendingTail[priority])
+		pendingTail[priority]->next = nc;
+	else
+		pendingHead[priority] = nc;
+
+	pendingTail[priority] = nc;
+}
+
+NodeCallback* CompletionQueue::dequeue() {
+	for(int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+		NodeCallback *nc = pendingHead[priority];
+		if(nc) {
+			pendingHead[priority] = nc->next;
+			if(!pendingHead[priority])
+				pendingTail[priority] = NULL;
+
+			nc->next = NULL;
+			return nc;
+		}
+	}
+
+	return NULL;
+}
+
+void CompletionQueue::asyncCallback(uv_async_t *handle) {
+	NodeCallback *stack = head.exchange(NULL, std::memory_order_acquire);
+
+	// The list was built by pushing onto the front; reverse it to deliver in completion order
+	NodeCallback *ready = NULL;
+	while(stack) {
+		NodeCallback *nc = stack;
+		stack = nc->next;
+		nc->next = ready;
+		ready = nc;
+	}
+
+	while(ready) {
+		NodeCallback *nc = ready;
+		ready = nc->next;
+		enqueue(nc);
+	}
+
+	uint64_t deadline = maxTime > 0 ? Stats::now() + maxTime : 0;
+	int count = 0;
+
+	NodeCallback *nc;
+	while((maxCount <= 0 || count < maxCount) && (nc = dequeue()) != NULL) {
+		++count;
+
+		nc->deliver();
+		nc->delRef();
+		release();
+
+		if(deadline > 0 && Stats::now() >= deadline)
+			break;
+	}
+
+	if(count > 0)
+		Stats::recordBatch(count);
+
+	// Signalling the handle again delivers the rest on the next turn of the event loop, after pending I/O
+	if(pendingHead[HIGH] || pendingHead[NORMAL])
+		uv_async_send(handle);
+}
+
+// Free lists are only touched on the node thread
+static const size_t FREE_LIST_GRANULARITY = 16;
+static const size_t FREE_LIST_BUCKETS = 16;
+static const size_t FREE_LIST_MAX_LENGTH = 1024;
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+static FreeBlock *freeLists[FREE_LIST_BUCKETS];
+static size_t freeListLengths[FREE_LIST_BUCKETS];
+
+static inline size_t freeListBucket(size_t size) {
+	return (size + FREE_LIST_GRANULARITY - 1) / FREE_LIST_GRANULARITY - 1;
+}
+
+void* NodeCallback::operator new(size_t size) {
+	size_t bucket = freeListBucket(size);
+	if(bucket >= FREE_LIST_BUCKETS)
+		return ::operator new(size);
+
+	FreeBlock *block = freeLists[bucket];
+	if(block) {
+		freeLists[bucket] = block->next;
+		--freeListLengths[bucket];
+		return block;
+	}
+
+	return ::operator new((bucket + 1) * FREE_LIST_GRANULARITY);
+}
+
+void NodeCallback::operator delete(void *ptr, size_t size) {
+	size_t bucket = freeListBucket(size);
+	if(bucket >= FREE_LIST_BUCKETS || freeListLengths[bucket] >= FREE_LIST_MAX_LENGTH) {
+		::operator delete(ptr);
+		return;
+	}
+
+	FreeBlock *block = (FreeBlock*)ptr;
+	block->next = freeLists[bucket];
+	freeLists[bucket] = block;
+	++freeListLengths[bucket];
+}
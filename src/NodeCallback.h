@@ -25,11 +25,13 @@
 #define FDB_NODE_NODE_CALLBACK_H
 
 #include "FdbError.h"
+#include "Stats.h"
 
 #include <v8.h>
 #include <cstdlib>
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
 #include <node.h>
 #include <nan.h>
 #include <node_buffer.h>
@@ -45,18 +47,102 @@ using namespace std;
 using namespace v8;
 using namespace node;
 
+struct NodeCallback;
+
+/*
+ * Reference-counted ownership of a future whose memory has been handed to
+ * JavaScript as external buffers. The future is destroyed once the callback
+ * and every buffer referencing it have released it.
+ */
+struct SharedFuture {
+	SharedFuture(FDBFuture *future) : future(future), refCount(1) { }
+
+	void addRef() {
+		++refCount;
+	}
+
+	void delRef() {
+		if(--refCount == 0) {
+			fdb_future_destroy(future);
+			delete this;
+		}
+	}
+
+	// Invoked on the node thread when a buffer referencing the future is garbage collected
+	static void freeCallback(char *data, void *hint) {
+		((SharedFuture*)hint)->delRef();
+	}
+
+	FDBFuture *future;
+	int refCount;
+};
+
+/*
+ * Futures that become ready on the network thread are pushed onto a single
+ * lock-free list and handed to the node thread through one long-lived async
+ * handle, which delivers everything that has accumulated in one batch.
+ *
+ * A delivery budget can bound how many callbacks (or how much time) one batch
+ * may take. Whatever is left over waits for the next turn of the event loop, so
+ * I/O gets a chance to run between slices of a large burst.
+ */
+class CompletionQueue {
+	public:
+		static void push(NodeCallback *nc);
+
+		// maxCount <= 0 and maxTime (in nanoseconds) of 0 mean no limit. With prioritizeCommits,
+		// commits that are ready are delivered ahead of every other kind of future.
+		static void setBudget(int maxCount, uint64_t maxTime, bool prioritizeCommits);
+
+		// fdb.setDeliveryBudget(maxCallbacks, maxTimeMicros, prioritizeCommits)
+		static void SetDeliveryBudget(const FunctionCallbackInfo<Value>& info);
+
+		// Called on the node thread for each callback that is started/delivered.
+		// The async handle only keeps the event loop alive while futures are outstanding.
+		static void retain();
+		static void release();
+
+		static int inFlight() {
+			return outstanding;
+		}
+
+	private:
+		static void init();
+		static void asyncCallback(uv_async_t *handle);
+
+		enum Priority { HIGH, NORMAL, PRIORITY_COUNT };
+
+		static void enqueue(NodeCallback *nc);
+		static NodeCallback* dequeue();
+
+		static std::atomic<NodeCallback*> head;
+
+		// Callbacks taken off of the lock-free list but not yet delivered, in completion order
+		static NodeCallback *pendingHead[PRIORITY_COUNT];
+		static NodeCallback *pendingTail[PRIORITY_COUNT];
+
+		static int maxCount;
+		static uint64_t maxTime;
+		static bool prioritizeCommits;
+
+		static uv_async_t handle;
+		static bool initialized;
+		static int outstanding;
+};
+
 struct NodeCallback {
 
 public:
-	NodeCallback(FDBFuture *future, Handle<Function> cbFunc0) : future(future), refCount(1) {
+	NodeCallback(FDBFuture *future, Handle<Function> cbFunc0) : future(future), refCount(1), next(NULL), rearmed(false), operation(Stats::OTHER), startTime(0), readyTime(0), zeroCopy(false), sharedFuture(NULL) {
 		Isolate *isolate = Isolate::GetCurrent();
 		cbFunc.Reset(isolate, cbFunc0);
-		uv_async_init(uv_default_loop(), &handle, &NodeCallback::nodeThreadCallback);
-		uv_ref((uv_handle_t*)&handle);
-		handle.data = this;
 	}
 
-	void start() {
+	void start(Stats::Operation operation = Stats::OTHER) {
+		this->operation = operation;
+		startTime = Stats::now();
+
+		CompletionQueue::retain();
 		if (fdb_future_set_callback(future, &NodeCallback::futureReadyCallback, this)) {
 			fprintf(stderr, "fdb_future_set_callback failed.\n");
 			abort();
@@ -65,7 +151,16 @@ public:
 
 	virtual ~NodeCallback() {
 		cbFunc.Reset();
-		fdb_future_destroy(future);
+		if(sharedFuture)
+			sharedFuture->delRef();
+		else
+			fdb_future_destroy(future);
+	}
+
+	// When set, buffers returned to JavaScript point directly into the future's memory
+	// instead of being copied. The future then lives as long as any of those buffers.
+	void setZeroCopy(bool zeroCopy) {
+		this->zeroCopy = zeroCopy;
 	}
 
 	void addRef() {
@@ -82,67 +177,123 @@ public:
 		return future;
 	}
 
-private:
-	void close() {
-		uv_close((uv_handle_t*)&handle, &NodeCallback::closeCallback);
-	}
+	// Calls a JavaScript callback with node-style (error, value) arguments
+	static void invokeCallback(Persistent<Function>& cbFunc, Handle<Value> jsError, Handle<Value> jsValue) {
+		Isolate *isolate = Isolate::GetCurrent();
+		Handle<Value> args[2] = { jsError, jsValue };
 
-	static void closeCallback(uv_handle_s *handle) {
-		NodeCallback *nc = (NodeCallback*)((uv_async_t*)handle)->data;
-		nc->delRef();
+		Local<Function> callback = Local<Function>::New(isolate, cbFunc);
+
+		v8::TryCatch ex;
+		callback->Call(isolate->GetCurrentContext()->Global(), 2, args);
+
+		if(ex.HasCaught())
+			fprintf(stderr, "\n%s\n", *String::Utf8Value(ex.StackTrace()->ToString()));
 	}
 
+	// Callbacks are allocated and freed on the node thread at a high rate, so freed
+	// objects are kept on a free list (keyed by size) and recycled
+	static void* operator new(size_t size);
+	static void operator delete(void *ptr, size_t size);
+
+private:
+	friend class CompletionQueue;
+
 	static void futureReadyCallback(FDBFuture *f, void *ptr) {
 		NodeCallback *nc = (NodeCallback*)ptr;
-		uv_async_send(&nc->handle);
+		nc->readyTime = Stats::now();
+		Stats::recordReady(nc->operation, nc->startTime, nc->readyTime);
+
+		CompletionQueue::push(nc);
 	}
 
-	static void nodeThreadCallback(uv_async_t *handle) {
-    Isolate *isolate = Isolate::GetCurrent();
-		NodeCallback *nc = (NodeCallback*)handle->data;
-		FDBFuture *future = nc->future;
+	void deliver() {
+		Isolate *isolate = Isolate::GetCurrent();
+		HandleScope handleScope(isolate);
 
-		uv_unref((uv_handle_t*)handle);
+		Stats::recordDelivery(operation, startTime, readyTime, Stats::now());
 
 		Handle<Value> jsError;
 		Handle<Value> jsValue;
 
 		fdb_error_t errorCode;
-		jsValue = nc->extractValue(future, errorCode);
+		jsValue = extractValue(future, errorCode);
+		if(rearmed) {
+			rearmed = false;
+			return;
+		}
+
 		if (errorCode == 0)
 			jsError = NanNull();
 		else
 			jsError = FdbError::NewInstance(errorCode, fdb_get_error(errorCode));
 
-		Handle<Value> args[2] = { jsError, jsValue };
-
-		Local<Function> callback = Local<Function>::New(isolate, nc->cbFunc);
-
-		v8::TryCatch ex;
-		callback->Call(isolate->GetCurrentContext()->Global(), 2, args);
-
-		if(ex.HasCaught())
-			fprintf(stderr, "\n%s\n", *String::Utf8Value(ex.StackTrace()->ToString()));
-
-		nc->close();
+		complete(jsError, jsValue);
 	}
 
 	FDBFuture* future;
-	uv_async_t handle;
 	Persistent<Function> cbFunc;
 	int refCount;
 
+	// Link used while this callback sits in the CompletionQueue
+	NodeCallback *next;
+
+	// Set when extractValue has started waiting on another future
+	bool rearmed;
+
+	Stats::Operation operation;
+	uint64_t startTime;
+	uint64_t readyTime;
+
 protected:
 	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) = 0;
 
-	static Handle<Value> makeBuffer(const char *arr, int length) {
+	// Hands the result of the future to JavaScript. By default, this calls the function passed to the constructor.
+	virtual void complete(Handle<Value> jsError, Handle<Value> jsValue) {
+		invokeCallback(cbFunc, jsError, jsValue);
+	}
+
+	/*
+	 * Replaces the completed future with another and waits on it, without calling
+	 * into JavaScript. May only be called from extractValue, by callbacks whose
+	 * result takes more than one request to produce.
+	 */
+	void rearm(FDBFuture *nextFuture) {
+		if(sharedFuture) {
+			sharedFuture->delRef();
+			sharedFuture = NULL;
+		}
+		else
+			fdb_future_destroy(future);
+
+		future = nextFuture;
+		rearmed = true;
+
+		// Balances the reference released when the completed future is delivered
+		addRef();
+		start(operation);
+	}
+
+	Handle<Value> makeBuffer(const char *arr, int length) {
 		Isolate *isolate = Isolate::GetCurrent();
 		EscapableHandleScope scope(isolate);
+
+		if(zeroCopy) {
+			if(!sharedFuture)
+				sharedFuture = new SharedFuture(future);
+
+			sharedFuture->addRef();
+			return scope.Escape(NanNewBufferHandle((char*)arr, length, &SharedFuture::freeCallback, sharedFuture));
+		}
+
 		Local<Object> buf = Buffer::New(isolate, length);
 		memcpy(Buffer::Data(buf), (const char*)arr, length);
 
 		return scope.Escape(buf);
 	}
+
+	bool zeroCopy;
+	SharedFuture *sharedFuture;
 };
 
 #endif
@@ -0,0 +1,192 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <node.h>
+
+#include "Stats.h"
+#include "NodeCallback.h"
+
+using namespace v8;
+
+static inline int highestBit(uint64_t value) {
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+	while(value >>= 1)
+		++bit;
+	return bit;
+#endif
+}
+
+Histogram::Histogram() {
+	reset();
+}
+
+int Histogram::bucketIndex(uint64_t value) {
+	if(value < SUB_BUCKETS)
+		return (int)value;
+
+	int bit = highestBit(value);
+	if(bit >= MAX_VALUE_BITS)
+		return BUCKETS - 1;
+
+	int shift = bit - SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKETS + (int)((value >> shift) - SUB_BUCKETS);
+}
+
+// The midpoint of the values that fall into a bucket
+uint64_t Histogram::bucketValue(int index) {
+	if(index < SUB_BUCKETS)
+		return index;
+
+	int shift = index / SUB_BUCKETS - 1;
+	uint64_t lower = (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+	return lower + ((uint64_t)1 << shift) / 2;
+}
+
+void Histogram::record(uint64_t value) {
+	buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t oldMax = max.load(std::memory_order_relaxed);
+	while(value > oldMax && !max.compare_exchange_weak(oldMax, value, std::memory_order_relaxed)) { }
+}
+
+// Values recorded concurrently with a reset may or may not be kept
+void Histogram::reset() {
+	for(int i = 0; i < BUCKETS; i++)
+		buckets[i].store(0, std::memory_order_relaxed);
+
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+Local<Object> Histogram::toObject(double scale) {
+	Isolate *isolate = Isolate::GetCurrent();
+	EscapableHandleScope scope(isolate);
+
+	uint64_t total = count.load(std::memory_order_relaxed);
+
+	static const int PERCENTILE_COUNT = 3;
+	static const double percentiles[PERCENTILE_COUNT] = { 0.5, 0.9, 0.99 };
+	static const char *percentileNames[PERCENTILE_COUNT] = { "p50", "p90", "p99" };
+	double percentileValues[PERCENTILE_COUNT] = { 0, 0, 0 };
+
+	if(total > 0) {
+		uint64_t seen = 0;
+		int next = 0;
+		for(int i = 0; i < BUCKETS && next < PERCENTILE_COUNT; i++) {
+			seen += buckets[i].load(std::memory_order_relaxed);
+			while(next < PERCENTILE_COUNT && seen >= percentiles[next] * total)
+				percentileValues[next++] = bucketValue(i) * scale;
+		}
+	}
+
+	Local<Object> obj = Object::New(isolate);
+	obj->Set(String::NewFromUtf8(isolate, "count", String::kInternalizedString), Number::New(isolate, (double)total));
+	obj->Set(String::NewFromUtf8(isolate, "mean", String::kInternalizedString),
+		Number::New(isolate, total > 0 ? (double)sum.load(std::memory_order_relaxed) / total * scale : 0));
+
+	for(int i = 0; i < PERCENTILE_COUNT; i++)
+		obj->Set(String::NewFromUtf8(isolate, percentileNames[i], String::kInternalizedString), Number::New(isolate, percentileValues[i]));
+
+	obj->Set(String::NewFromUtf8(isolate, "max", String::kInternalizedString), Number::New(isolate, max.load(std::memory_order_relaxed) * scale));
+
+	return scope.Escape(obj);
+}
+
+Histogram Stats::server[Stats::OPERATION_COUNT];
+Histogram Stats::queue[Stats::OPERATION_COUNT];
+Histogram Stats::latency[Stats::OPERATION_COUNT];
+Histogram Stats::batches;
+
+static const char *operationNames[Stats::OPERATION_COUNT] = {
+	"get",
+	"getKey",
+	"getRange",
+	"commit",
+	"getReadVersion",
+	"watch",
+	"onError",
+	"other"
+};
+
+// Called on the network thread
+void Stats::recordReady(Operation op, uint64_t startTime, uint64_t readyTime) {
+	server[op].record(readyTime - startTime);
+}
+
+void Stats::recordDelivery(Operation op, uint64_t startTime, uint64_t readyTime, uint64_t deliveryTime) {
+	queue[op].record(deliveryTime - readyTime);
+	latency[op].record(deliveryTime - startTime);
+}
+
+void Stats::recordBatch(int size) {
+	batches.record(size);
+}
+
+/*
+ * Returns:
+ *  {
+ *  	inFlight: <futures not yet delivered>,
+ *  	operations: { get: { server: <histogram>, queue: <histogram>, latency: <histogram> }, ... },
+ *  	batches: <histogram of the number of futures delivered per wakeup>
+ *  }
+ *
+ * Durations are in microseconds.
+ */
+void Stats::Get(const FunctionCallbackInfo<Value>& info) {
+	Isolate *isolate = Isolate::GetCurrent();
+	const double NANOSECONDS_TO_MICROSECONDS = 1e-3;
+
+	Local<Object> operations = Object::New(isolate);
+	for(int i = 0; i < OPERATION_COUNT; i++) {
+		Local<Object> op = Object::New(isolate);
+		op->Set(String::NewFromUtf8(isolate, "server", String::kInternalizedString), server[i].toObject(NANOSECONDS_TO_MICROSECONDS));
+		op->Set(String::NewFromUtf8(isolate, "queue", String::kInternalizedString), queue[i].toObject(NANOSECONDS_TO_MICROSECONDS));
+		op->Set(String::NewFromUtf8(isolate, "latency", String::kInternalizedString), latency[i].toObject(NANOSECONDS_TO_MICROSECONDS));
+		operations->Set(String::NewFromUtf8(isolate, operationNames[i], String::kInternalizedString), op);
+	}
+
+	Local<Object> stats = Object::New(isolate);
+	stats->Set(String::NewFromUtf8(isolate, "inFlight", String::kInternalizedString), Integer::New(isolate, CompletionQueue::inFlight()));
+	stats->Set(String::NewFromUtf8(isolate, "operations", String::kInternalizedString), operations);
+	stats->Set(String::NewFromUtf8(isolate, "batches", String::kInternalizedString), batches.toObject(1));
+
+	info.GetReturnValue().Set(stats);
+}
+
+void Stats::Reset(const FunctionCallbackInfo<Value>& info) {
+	for(int i = 0; i < OPERATION_COUNT; i++) {
+		server[i].reset();
+		queue[i].reset();
+		latency[i].reset();
+	}
+
+	batches.reset();
+
+	info.GetReturnValue().SetNull();
+}
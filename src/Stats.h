@@ -0,0 +1,105 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FDB_NODE_STATS_H
+#define FDB_NODE_STATS_H
+
+#include "Version.h"
+
+#include <node.h>
+#include <uv.h>
+#include <stdint.h>
+#include <atomic>
+
+/*
+ * A log-linear histogram of nanosecond durations (or any other non-negative counts).
+ * Each power of two is split into 16 buckets, so recorded values are accurate to
+ * about 6%. Recording is lock-free, and may happen on any thread.
+ */
+class Histogram {
+	public:
+		Histogram();
+
+		void record(uint64_t value);
+		void reset();
+
+		// Returns {count, mean, p50, p90, p99, max}, with values multiplied by scale
+		v8::Local<v8::Object> toObject(double scale);
+
+	private:
+		static const int SUB_BUCKET_BITS = 4;
+		static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+		static const int MAX_VALUE_BITS = 44;
+		static const int BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+		static int bucketIndex(uint64_t value);
+		static uint64_t bucketValue(int index);
+
+		std::atomic<uint64_t> buckets[BUCKETS];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+		std::atomic<uint64_t> max;
+};
+
+/*
+ * Timing of the futures handed out by the binding. For each kind of operation, three
+ * durations are recorded: from the request to the future becoming ready on the network
+ * thread (server), from then until the node thread delivers it (queue), and the sum of
+ * the two (latency). Delivery batch sizes and the number of futures in flight are also kept.
+ */
+class Stats {
+	public:
+		enum Operation {
+			GET,
+			GET_KEY,
+			GET_RANGE,
+			COMMIT,
+			GET_READ_VERSION,
+			WATCH,
+			ON_ERROR,
+			OTHER,
+			OPERATION_COUNT
+		};
+
+		static uint64_t now() {
+			return uv_hrtime();
+		}
+
+		static void recordReady(Operation op, uint64_t startTime, uint64_t readyTime);
+		static void recordDelivery(Operation op, uint64_t startTime, uint64_t readyTime, uint64_t deliveryTime);
+		static void recordBatch(int size);
+
+		// fdb.stats() and fdb.resetStats()
+		static void Get(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void Reset(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+	private:
+		Stats();  // not implemented by design
+
+		static Histogram server[OPERATION_COUNT];
+		static Histogram queue[OPERATION_COUNT];
+		static Histogram latency[OPERATION_COUNT];
+		static Histogram batches;
+};
+
+#endif
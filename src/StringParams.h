@@ -0,0 +1,92 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FDB_NODE_STRING_PARAMS_H
+#define FDB_NODE_STRING_PARAMS_H
+
+#include <node.h>
+#include <node_buffer.h>
+#include <stdint.h>
+
+/*
+ * The bytes of a key, value or other byte string argument. Buffers, TypedArrays
+ * (and DataViews) and ArrayBuffers are read in place. Strings are encoded as UTF-8
+ * into storage on the stack, or into a heap buffer if they are too long for it.
+ * Any other value is read as empty, so callers must check Accepts first.
+ */
+struct StringParams {
+	uint8_t *str;
+	int len;
+
+	StringParams(v8::Handle<v8::Value> val) : str(NULL), len(0), heapStorage(NULL) {
+		if(node::Buffer::HasInstance(val)) {
+			v8::Local<v8::Object> obj = val->ToObject();
+			str = (uint8_t*)node::Buffer::Data(obj);
+			len = (int)node::Buffer::Length(obj);
+		}
+		else if(val->IsString()) {
+			v8::Local<v8::String> string = v8::Local<v8::String>::Cast(val);
+			int capacity = string->Utf8Length();
+			if(capacity <= STACK_STORAGE_SIZE)
+				str = stackStorage;
+			else
+				str = heapStorage = new uint8_t[capacity];
+
+			len = string->WriteUtf8((char*)str, capacity, NULL, v8::String::NO_NULL_TERMINATION);
+		}
+		else if(val->IsArrayBufferView()) {
+			// Buffer() moves the contents of small typed arrays, which V8 keeps on its heap, into external memory
+			v8::Local<v8::ArrayBufferView> view = v8::Local<v8::ArrayBufferView>::Cast(val);
+			setBytes(v8::Uint8Array::New(view->Buffer(), view->ByteOffset(), view->ByteLength()));
+		}
+		else if(val->IsArrayBuffer()) {
+			v8::Local<v8::ArrayBuffer> buffer = v8::Local<v8::ArrayBuffer>::Cast(val);
+			setBytes(v8::Uint8Array::New(buffer, 0, buffer->ByteLength()));
+		}
+	}
+
+	~StringParams() {
+		delete[] heapStorage;
+	}
+
+	// Whether val is one of the kinds of argument that can be read as bytes
+	static bool Accepts(v8::Handle<v8::Value> val) {
+		return node::Buffer::HasInstance(val) || val->IsString() || val->IsArrayBufferView() || val->IsArrayBuffer();
+	}
+
+private:
+	StringParams(const StringParams&);  // not implemented by design
+	StringParams& operator=(const StringParams&);  // not implemented by design
+
+	void setBytes(v8::Local<v8::Uint8Array> bytes) {
+		str = (uint8_t*)bytes->GetIndexedPropertiesExternalArrayData();
+		len = (int)bytes->ByteLength();
+	}
+
+	static const int STACK_STORAGE_SIZE = 256;
+
+	uint8_t stackStorage[STACK_STORAGE_SIZE];
+	uint8_t *heapStorage;
+};
+
+#endif
@@ -33,15 +33,18 @@
 #include "NodeCallback.h"
 #include "FdbError.h"
 #include "FdbOptions.h"
+#include "V8Cache.h"
+#include "StringParams.h"
 
 using namespace v8;
 using namespace std;
 using namespace node;
 
 // Transaction Implementation
-Transaction::Transaction() { };
+Transaction::Transaction() : zeroCopyResults(false) { };
 
 Transaction::~Transaction() {
+	options.Reset();
 	fdb_transaction_destroy(tr);
 };
 
@@ -73,6 +76,67 @@ struct NodeValueCallback : NodeCallback {
 	}
 };
 
+/*
+ * Collects the results of the reads issued by a single getMany call. The
+ * JavaScript callback is invoked once, after the last read completes, with
+ * either the first error encountered or an array of values in key order.
+ */
+struct MultiGet {
+	MultiGet(int count, Handle<Function> cbFunc0) : remaining(count) {
+		Isolate *isolate = Isolate::GetCurrent();
+		cbFunc.Reset(isolate, cbFunc0);
+		results.Reset(isolate, Array::New(isolate, count));
+	}
+
+	~MultiGet() {
+		cbFunc.Reset();
+		results.Reset();
+		error.Reset();
+	}
+
+	void complete(int index, Handle<Value> jsError, Handle<Value> jsValue) {
+		Isolate *isolate = Isolate::GetCurrent();
+
+		if(!jsError->IsNull()) {
+			if(error.IsEmpty())
+				error.Reset(isolate, jsError);
+		}
+		else
+			Local<Array>::New(isolate, results)->Set(index, jsValue);
+
+		if(--remaining == 0)
+			finish();
+	}
+
+	void finish() {
+		Isolate *isolate = Isolate::GetCurrent();
+
+		if(error.IsEmpty())
+			NodeCallback::invokeCallback(cbFunc, NanNull(), Local<Array>::New(isolate, results));
+		else
+			NodeCallback::invokeCallback(cbFunc, Local<Value>::New(isolate, error), Undefined(isolate));
+
+		delete this;
+	}
+
+	int remaining;
+	Persistent<Function> cbFunc;
+	Persistent<Array> results;
+	Persistent<Value> error;
+};
+
+struct NodeMultiValueCallback : NodeValueCallback {
+
+	NodeMultiValueCallback(FDBFuture *future, MultiGet *multiGet, int index) : NodeValueCallback(future, Handle<Function>()), multiGet(multiGet), index(index) { }
+
+	virtual void complete(Handle<Value> jsError, Handle<Value> jsValue) {
+		multiGet->complete(index, jsError, jsValue);
+	}
+
+	MultiGet *multiGet;
+	int index;
+};
+
 struct NodeKeyCallback : NodeCallback {
 
 	NodeKeyCallback(FDBFuture *future, Handle<Function> cbFunc) : NodeCallback(future, cbFunc) { }
@@ -104,9 +168,28 @@ struct NodeVoidCallback : NodeCallback {
 	}
 };
 
-struct NodeKeyValueCallback : NodeCallback {
+/*
+ * Base of the callbacks of range reads. Each batch that is read moves the read's
+ * RangeSpec past it, so the next request can be issued from the same spec.
+ */
+struct NodeRangeCallback : NodeCallback {
+
+	NodeRangeCallback(FDBFuture *future, Handle<Object> specObj, Handle<Function> cbFunc) : NodeCallback(future, cbFunc) {
+		spec = node::ObjectWrap::Unwrap<RangeSpec>(specObj);
+		specHandle.Reset(Isolate::GetCurrent(), specObj);
+	}
+
+	virtual ~NodeRangeCallback() {
+		specHandle.Reset();
+	}
+
+	RangeSpec *spec;
+	Persistent<Object> specHandle;
+};
+
+struct NodeKeyValueCallback : NodeRangeCallback {
 
-	NodeKeyValueCallback(FDBFuture *future, Handle<Function> cbFunc) : NodeCallback(future, cbFunc) { }
+	NodeKeyValueCallback(FDBFuture *future, Handle<Object> specObj, Handle<Function> cbFunc) : NodeRangeCallback(future, specObj, cbFunc) { }
 
 	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) {
 		Isolate *isolate = Isolate::GetCurrent();
@@ -119,6 +202,8 @@ struct NodeKeyValueCallback : NodeCallback {
 		outErr = fdb_future_get_keyvalue_array(future, &kv, &len, &more);
 		if (outErr) return Undefined(isolate);
 
+		more = spec->advance(kv, len, more);
+
 		/*
 		 * Constructing a JavaScript array of KeyValue objects:
 		 *  {
@@ -131,11 +216,12 @@ struct NodeKeyValueCallback : NodeCallback {
 		Local<Object> returnObj = Local<Object>::New(isolate, Object::New(isolate));
 		Handle<Array> jsValueArray = Array::New(isolate, len);
 
-		Handle<String> keySymbol = String::NewFromUtf8(isolate, "key", String::kInternalizedString);
-		Handle<String> valueSymbol = String::NewFromUtf8(isolate, "value", String::kInternalizedString);
+		Local<ObjectTemplate> keyValueTemplate = V8Cache::GetKeyValueTemplate();
+		Local<String> keySymbol = V8Cache::GetString(V8Cache::KEY);
+		Local<String> valueSymbol = V8Cache::GetString(V8Cache::VALUE);
 
 		for(int i = 0; i < len; i++) {
-			Local<Object> jsKeyValue = Object::New(isolate);
+			Local<Object> jsKeyValue = keyValueTemplate->NewInstance();
 
 			Handle<Value> jsKeyBuffer = makeBuffer((const char*)kv[i].key, kv[i].key_length);
 			Handle<Value> jsValueBuffer = makeBuffer((const char*)kv[i].value, kv[i].value_length);
@@ -145,14 +231,182 @@ struct NodeKeyValueCallback : NodeCallback {
 			jsValueArray->Set(Number::New(isolate, i), jsKeyValue);
 		}
 
-		returnObj->Set(String::NewFromUtf8(isolate, "array", String::kInternalizedString), jsValueArray);
+		returnObj->Set(V8Cache::GetString(V8Cache::ARRAY), jsValueArray);
 		if(more)
-			returnObj->Set(String::NewFromUtf8(isolate, "more", String::kInternalizedString), Number::New(isolate, 1));
+			returnObj->Set(V8Cache::GetString(V8Cache::MORE), Number::New(isolate, 1));
 
 		return scope.Escape(returnObj);
 	}
 };
 
+struct NodePackedKeyValueCallback : NodeRangeCallback {
+
+	NodePackedKeyValueCallback(FDBFuture *future, Handle<Object> specObj, Handle<Function> cbFunc) : NodeRangeCallback(future, specObj, cbFunc) { }
+
+	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) {
+		Isolate *isolate = Isolate::GetCurrent();
+		EscapableHandleScope scope(isolate);
+
+		const FDBKeyValue *kv;
+		int len;
+		fdb_bool_t more;
+
+		outErr = fdb_future_get_keyvalue_array(future, &kv, &len, &more);
+		if (outErr) return Undefined(isolate);
+
+		more = spec->advance(kv, len, more);
+
+		/*
+		 * Constructing a packed batch of key-value pairs:
+		 *  {
+		 *  	buffer: <all keys and values, back to back>,
+		 *  	offsets: Uint32Array [ key0, value0, key1, value1, ..., end ]
+		 *  }
+		 *
+		 * The ith key spans offsets[2i] to offsets[2i+1], and its value spans
+		 * offsets[2i+1] to offsets[2i+2].
+		 */
+
+		size_t totalLength = 0;
+		for(int i = 0; i < len; i++)
+			totalLength += kv[i].key_length + kv[i].value_length;
+
+		Local<Object> buffer = Buffer::New(isolate, totalLength);
+		char *data = Buffer::Data(buffer);
+
+		Local<ArrayBuffer> offsetStorage = ArrayBuffer::New(isolate, (2 * len + 1) * sizeof(uint32_t));
+		Local<Uint32Array> offsets = Uint32Array::New(offsetStorage, 0, 2 * len + 1);
+		uint32_t *offsetData = (uint32_t*)offsets->GetIndexedPropertiesExternalArrayData();
+
+		uint32_t pos = 0;
+		for(int i = 0; i < len; i++) {
+			offsetData[2 * i] = pos;
+			memcpy(data + pos, kv[i].key, kv[i].key_length);
+			pos += kv[i].key_length;
+
+			offsetData[2 * i + 1] = pos;
+			memcpy(data + pos, kv[i].value, kv[i].value_length);
+			pos += kv[i].value_length;
+		}
+		offsetData[2 * len] = pos;
+
+		Local<Object> returnObj = Object::New(isolate);
+		returnObj->Set(V8Cache::GetString(V8Cache::BUFFER), buffer);
+		returnObj->Set(V8Cache::GetString(V8Cache::OFFSETS), offsets);
+		if(more)
+			returnObj->Set(V8Cache::GetString(V8Cache::MORE), Number::New(isolate, 1));
+
+		return scope.Escape(returnObj);
+	}
+};
+
+/*
+ * Reads an entire range natively. Each batch is copied once, into one growing block
+ * of memory, and the next request is issued from C++. JavaScript is only called once,
+ * with the whole range in the packed form of NodePackedKeyValueCallback; the block
+ * becomes the result's buffer without being copied again.
+ */
+struct NodeRangeAllCallback : NodeRangeCallback {
+
+	NodeRangeAllCallback(FDBFuture *future, FDBTransaction *tr, Handle<Object> trObj, Handle<Object> specObj, Handle<Function> cbFunc)
+		: NodeRangeCallback(future, specObj, cbFunc), tr(tr), data(NULL), size(0), capacity(0)
+	{
+		transaction.Reset(Isolate::GetCurrent(), trObj);
+	}
+
+	virtual ~NodeRangeAllCallback() {
+		transaction.Reset();
+		free(data);
+	}
+
+	virtual Handle<Value> extractValue(FDBFuture* future, fdb_error_t& outErr) {
+		Isolate *isolate = Isolate::GetCurrent();
+		EscapableHandleScope scope(isolate);
+
+		const FDBKeyValue *kv;
+		int len;
+		fdb_bool_t more;
+
+		outErr = fdb_future_get_keyvalue_array(future, &kv, &len, &more);
+		if (outErr) return Undefined(isolate);
+
+		size_t batchLength = 0;
+		for(int i = 0; i < len; i++)
+			batchLength += kv[i].key_length + kv[i].value_length;
+
+		reserve(size + batchLength);
+		for(int i = 0; i < len; i++) {
+			offsets.push_back((uint32_t)size);
+			memcpy(data + size, kv[i].key, kv[i].key_length);
+			size += kv[i].key_length;
+
+			offsets.push_back((uint32_t)size);
+			memcpy(data + size, kv[i].value, kv[i].value_length);
+			size += kv[i].value_length;
+		}
+
+		if(spec->advance(kv, len, more) && len > 0) {
+			rearm(spec->request(tr));
+			return Undefined(isolate);
+		}
+
+		offsets.push_back((uint32_t)size);
+
+		// See NodePackedKeyValueCallback for the layout of the result
+		Local<Object> buffer;
+		if(size > 0) {
+			buffer = NanNewBufferHandle(data, size, &freeData, NULL);
+			data = NULL;
+		}
+		else
+			buffer = Buffer::New(isolate, 0);
+
+		Local<ArrayBuffer> offsetStorage = ArrayBuffer::New(isolate, offsets.size() * sizeof(uint32_t));
+		Local<Uint32Array> jsOffsets = Uint32Array::New(offsetStorage, 0, offsets.size());
+		memcpy(jsOffsets->GetIndexedPropertiesExternalArrayData(), &offsets[0], offsets.size() * sizeof(uint32_t));
+
+		Local<Object> returnObj = Object::New(isolate);
+		returnObj->Set(V8Cache::GetString(V8Cache::BUFFER), buffer);
+		returnObj->Set(V8Cache::GetString(V8Cache::OFFSETS), jsOffsets);
+
+		return scope.Escape(returnObj);
+	}
+
+	// Grows data geometrically, so that appending every batch is linear in the size of the range
+	void reserve(size_t required) {
+		if(required <= capacity)
+			return;
+
+		size_t newCapacity = capacity > 0 ? capacity * 2 : 4096;
+		while(newCapacity < required)
+			newCapacity *= 2;
+
+		char *newData = (char*)realloc(data, newCapacity);
+		if(!newData) {
+			fprintf(stderr, "Out of memory reading a range\n");
+			abort();
+		}
+
+		data = newData;
+		capacity = newCapacity;
+	}
+
+	// Invoked on the node thread when the result's buffer is garbage collected
+	static void freeData(char *data, void *hint) {
+		free(data);
+	}
+
+	// Keeps the transaction alive until the whole range has been read
+	Persistent<Object> transaction;
+	FDBTransaction *tr;
+
+	// Every key and value read so far, back to back, and where each one starts
+	char *data;
+	size_t size;
+	size_t capacity;
+	vector<uint32_t> offsets;
+};
+
 struct NodeVersionCallback : NodeCallback {
 
 	NodeVersionCallback(FDBFuture *future, Handle<Function> cbFunc) : NodeCallback(future, cbFunc) { }
@@ -195,21 +449,6 @@ struct NodeStringArrayCallback : NodeCallback {
 	}
 };
 
-struct StringParams {
-	uint8_t *str;
-	int len;
-
-	/*
-	 *  String arguments always have to be buffers to
-	 *  preserve bytes. Otherwise, stuff gets converted
-	 *  to UTF-8.
-	 */
-	StringParams(Handle<Value> keyVal) {
-		str = (uint8_t*)(Buffer::Data(keyVal->ToObject()));
-		len = (int)Buffer::Length(keyVal->ToObject());
-	}
-};
-
 FDBTransaction* Transaction::GetTransactionFromArgs(const FunctionCallbackInfo<Value>& info) {
 	return node::ObjectWrap::Unwrap<Transaction>(info.Holder())->tr;
 }
@@ -221,7 +460,22 @@ Handle<Function> Transaction::GetCallback(Handle<Value> funcVal) {
 	return scope.Escape(callback);
 }
 
+// Throws a TypeError unless the first count arguments can all be read as byte strings
+static bool CheckByteArguments(const FunctionCallbackInfo<Value>& info, int count) {
+	for(int i = 0; i < count; i++) {
+		if(!StringParams::Accepts(info[i])) {
+			NanThrowTypeError("Keys and values must be strings, Buffers, TypedArrays or ArrayBuffers");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void Transaction::Set(const FunctionCallbackInfo<Value>& info){
+	if(!CheckByteArguments(info, 2))
+		return;
+
 	StringParams key(info[0]);
 	StringParams val(info[1]);
 	fdb_transaction_set(GetTransactionFromArgs(info), key.str, key.len, val.str, val.len);
@@ -231,12 +485,15 @@ void Transaction::Set(const FunctionCallbackInfo<Value>& info){
 
 void Transaction::Commit(const FunctionCallbackInfo<Value>& info) {
 	FDBFuture *f = fdb_transaction_commit(GetTransactionFromArgs(info));
-	(new NodeVoidCallback(f, GetCallback(info[0])))->start();
+	(new NodeVoidCallback(f, GetCallback(info[0])))->start(Stats::COMMIT);
 
 	info.GetReturnValue().SetNull();
 }
 
 void Transaction::Clear(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 1))
+		return;
+
 	StringParams key(info[0]);
 	fdb_transaction_clear(GetTransactionFromArgs(info), key.str, key.len);
 
@@ -247,6 +504,9 @@ void Transaction::Clear(const FunctionCallbackInfo<Value>& info) {
  * ClearRange takes two key strings.
  */
 void Transaction::ClearRange(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 2))
+		return;
+
 	StringParams begin(info[0]);
 	StringParams end(info[1]);
 	fdb_transaction_clear_range(GetTransactionFromArgs(info), begin.str, begin.len, end.str, end.len);
@@ -254,50 +514,246 @@ void Transaction::ClearRange(const FunctionCallbackInfo<Value>& info) {
 	info.GetReturnValue().SetNull();
 }
 
+/*
+ * Mutation logs are a sequence of records, each an opcode byte followed by its operands.
+ * Byte string operands are encoded as a little-endian uint32 length and then the bytes.
+ *
+ *   MUTATION_SET          key, value
+ *   MUTATION_CLEAR        key
+ *   MUTATION_CLEAR_RANGE  begin, end
+ *   MUTATION_ATOMIC       uint8 FDBMutationType, key, param
+ */
+enum MutationOpcode {
+	MUTATION_SET = 0,
+	MUTATION_CLEAR = 1,
+	MUTATION_CLEAR_RANGE = 2,
+	MUTATION_ATOMIC = 3
+};
+
+struct MutationReader {
+	const uint8_t *pos;
+	const uint8_t *end;
+
+	MutationReader(const uint8_t *data, size_t length) : pos(data), end(data + length) { }
+
+	bool done() {
+		return pos == end;
+	}
+
+	bool readByte(uint8_t &out) {
+		if(pos == end)
+			return false;
+
+		out = *pos++;
+		return true;
+	}
+
+	bool readBytes(const uint8_t *&out, int &outLength) {
+		if(end - pos < 4)
+			return false;
+
+		uint32_t length = (uint32_t)pos[0] | ((uint32_t)pos[1] << 8) | ((uint32_t)pos[2] << 16) | ((uint32_t)pos[3] << 24);
+		pos += 4;
+
+		if((size_t)(end - pos) < length)
+			return false;
+
+		out = pos;
+		outLength = (int)length;
+		pos += length;
+		return true;
+	}
+};
+
+// Walks a mutation log, applying each record to tr if it is non-NULL. Returns false if the log is malformed.
+static bool ProcessMutations(FDBTransaction *tr, const uint8_t *data, size_t length) {
+	MutationReader reader(data, length);
+
+	while(!reader.done()) {
+		uint8_t opcode;
+		uint8_t mutationType = 0;
+		const uint8_t *param1;
+		const uint8_t *param2 = NULL;
+		int param1Length;
+		int param2Length = 0;
+
+		if(!reader.readByte(opcode))
+			return false;
+		if(opcode == MUTATION_ATOMIC && !reader.readByte(mutationType))
+			return false;
+		if(!reader.readBytes(param1, param1Length))
+			return false;
+		if(opcode != MUTATION_CLEAR && !reader.readBytes(param2, param2Length))
+			return false;
+
+		switch(opcode) {
+			case MUTATION_SET:
+				if(tr) fdb_transaction_set(tr, param1, param1Length, param2, param2Length);
+				break;
+			case MUTATION_CLEAR:
+				if(tr) fdb_transaction_clear(tr, param1, param1Length);
+				break;
+			case MUTATION_CLEAR_RANGE:
+				if(tr) fdb_transaction_clear_range(tr, param1, param1Length, param2, param2Length);
+				break;
+			case MUTATION_ATOMIC:
+				if(tr) fdb_transaction_atomic_op(tr, param1, param1Length, param2, param2Length, (FDBMutationType)mutationType);
+				break;
+			default:
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Takes a buffer containing a mutation log and the number of bytes of it that are in use.
+ * The log is validated in full before anything is applied, so a malformed log has no effect.
+ */
+void Transaction::ApplyMutations(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 1))
+		return;
+
+	StringParams log(info[0]);
+	size_t length = info.Length() > 1 && info[1]->IsNumber() ? (size_t)info[1]->Uint32Value() : (size_t)log.len;
+
+	if(length > (size_t)log.len || !ProcessMutations(NULL, log.str, length))
+		return NanThrowRangeError("Malformed mutation log");
+
+	ProcessMutations(GetTransactionFromArgs(info), log.str, length);
+
+	info.GetReturnValue().SetNull();
+}
+
 /*
  * This function takes a KeySelector and returns a future.
  */
 void Transaction::GetKey(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 1))
+		return;
+
 	StringParams key(info[0]);
 	int selectorOrEqual = info[1]->Int32Value();
 	int selectorOffset = info[2]->Int32Value();
 	bool snapshot = info[3]->BooleanValue();
 
-	FDBFuture *f = fdb_transaction_get_key(GetTransactionFromArgs(info), key.str, key.len, (fdb_bool_t)selectorOrEqual, selectorOffset, snapshot);
-	(new NodeKeyCallback(f, GetCallback(info[4])))->start();
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+	FDBFuture *f = fdb_transaction_get_key(trPtr->tr, key.str, key.len, (fdb_bool_t)selectorOrEqual, selectorOffset, snapshot);
+
+	NodeCallback *callback = new NodeKeyCallback(f, GetCallback(info[4]));
+	callback->setZeroCopy(trPtr->zeroCopyResults);
+	callback->start(Stats::GET_KEY);
 
 	info.GetReturnValue().SetNull();
 }
 
 void Transaction::Get(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 1))
+		return;
+
 	StringParams key(info[0]);
 	bool snapshot = info[1]->BooleanValue();
 
-	FDBFuture *f = fdb_transaction_get(GetTransactionFromArgs(info), key.str, key.len, snapshot);
-	(new NodeValueCallback(f, GetCallback(info[2])))->start();
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+	FDBFuture *f = fdb_transaction_get(trPtr->tr, key.str, key.len, snapshot);
+
+	NodeCallback *callback = new NodeValueCallback(f, GetCallback(info[2]));
+	callback->setZeroCopy(trPtr->zeroCopyResults);
+	callback->start(Stats::GET);
+
+	info.GetReturnValue().SetNull();
+}
+
+/*
+ * Takes an array of keys and issues a read for each of them. The callback
+ * receives an array of the values once all of the reads have completed.
+ */
+void Transaction::GetMany(const FunctionCallbackInfo<Value>& info) {
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+	if(!info[0]->IsArray())
+		return NanThrowTypeError("getMany must be called with an array of keys");
+
+	Local<Array> keys = Local<Array>::Cast(info[0]);
+	bool snapshot = info[1]->BooleanValue();
+	int count = (int)keys->Length();
+
+	// Checked before any read is issued, so that a bad key has no effect
+	for(int i = 0; i < count; i++) {
+		if(!StringParams::Accepts(keys->Get(i)))
+			return NanThrowTypeError("Keys and values must be strings, Buffers, TypedArrays or ArrayBuffers");
+	}
+
+	// lib/transaction.js answers an empty getMany itself, on the next tick like any other read
+	MultiGet *multiGet = new MultiGet(count, GetCallback(info[2]));
+	if(count == 0) {
+		multiGet->finish();
+		return info.GetReturnValue().SetNull();
+	}
+
+	for(int i = 0; i < count; i++) {
+		StringParams key(keys->Get(i));
+		FDBFuture *f = fdb_transaction_get(trPtr->tr, key.str, key.len, snapshot);
+
+		NodeCallback *callback = new NodeMultiValueCallback(f, multiGet, i);
+		callback->setZeroCopy(trPtr->zeroCopyResults);
+		callback->start(Stats::GET);
+	}
 
 	info.GetReturnValue().SetNull();
 }
 
+/*
+ * The range reads take a RangeSpec, which holds the selectors, limit, streaming mode
+ * and iteration of the read, and a callback. The spec is advanced past each batch
+ * before the callback is called, ready for the request for the next batch.
+ */
 void Transaction::GetRange(const FunctionCallbackInfo<Value>& info) {
-	StringParams start(info[0]);
-	int startOrEqual = info[1]->Int32Value();
-	int startOffset = info[2]->Int32Value();
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+	Local<Object> specObj = info[0]->ToObject();
+	FDBFuture *f = node::ObjectWrap::Unwrap<RangeSpec>(specObj)->request(trPtr->tr);
 
-	StringParams end(info[3]);
-	int endOrEqual = info[4]->Int32Value();
-	int endOffset = info[5]->Int32Value();
+	NodeCallback *callback = new NodeKeyValueCallback(f, specObj, GetCallback(info[1]));
+	callback->setZeroCopy(trPtr->zeroCopyResults);
+	callback->start(Stats::GET_RANGE);
 
-	int limit = info[6]->Int32Value();
-	FDBStreamingMode mode = (FDBStreamingMode)info[7]->Int32Value();
-	int iteration = info[8]->Int32Value();
-	bool snapshot = info[9]->BooleanValue();
-	bool reverse = info[10]->BooleanValue();
+	info.GetReturnValue().SetNull();
+}
 
-	FDBFuture *f = fdb_transaction_get_range(GetTransactionFromArgs(info), start.str, start.len, (fdb_bool_t)startOrEqual, startOffset,
-												end.str, end.len, (fdb_bool_t)endOrEqual, endOffset, limit, 0, mode, iteration, snapshot, reverse);
+/*
+ * Takes the same arguments as GetRange, but delivers the batch as a single
+ * buffer plus an offset table instead of an array of KeyValue objects.
+ */
+void Transaction::GetRangePacked(const FunctionCallbackInfo<Value>& info) {
+	Local<Object> specObj = info[0]->ToObject();
+	FDBFuture *f = node::ObjectWrap::Unwrap<RangeSpec>(specObj)->request(GetTransactionFromArgs(info));
+	(new NodePackedKeyValueCallback(f, specObj, GetCallback(info[1])))->start(Stats::GET_RANGE);
 
-	(new NodeKeyValueCallback(f, GetCallback(info[11])))->start();
+	info.GetReturnValue().SetNull();
+}
+
+/*
+ * Takes the same arguments as GetRange, but keeps issuing requests until the
+ * range (or the limit) is exhausted, then calls back once with every KeyValue.
+ */
+void Transaction::GetRangeAll(const FunctionCallbackInfo<Value>& info) {
+	FDBTransaction *tr = GetTransactionFromArgs(info);
+	Local<Object> specObj = info[0]->ToObject();
+	FDBFuture *f = node::ObjectWrap::Unwrap<RangeSpec>(specObj)->request(tr);
+
+	(new NodeRangeAllCallback(f, tr, info.Holder(), specObj, GetCallback(info[1])))->start(Stats::GET_RANGE);
+
+	info.GetReturnValue().SetNull();
+}
+
+/*
+ * Controls whether keys and values returned by get, getKey and getRange reference
+ * the memory of the underlying future instead of being copied. Any one of these
+ * buffers keeps the whole result of its read alive.
+ */
+void Transaction::SetZeroCopyResults(const FunctionCallbackInfo<Value>& info) {
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+	trPtr->zeroCopyResults = info[0]->BooleanValue();
 
 	info.GetReturnValue().SetNull();
 }
@@ -306,20 +762,25 @@ void Transaction::Watch(const FunctionCallbackInfo<Value>& info) {
 	Isolate *isolate = Isolate::GetCurrent();
 	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
 
-	uint8_t *keyStr = (uint8_t*)(Buffer::Data(info[0]->ToObject()));
-	int keyLen = (int)Buffer::Length(info[0]->ToObject());
+	if(!CheckByteArguments(info, 1))
+		return;
+
+	StringParams key(info[0]);
 
 	Local<Function> cb = Local<Function>::New(isolate, Handle<Function>::Cast(info[1]));
 
-	FDBFuture *f = fdb_transaction_watch(trPtr->tr, keyStr, keyLen);
+	FDBFuture *f = fdb_transaction_watch(trPtr->tr, key.str, key.len);
 	NodeVoidCallback *callback = new NodeVoidCallback(f, cb);
 	Handle<Value> watch = Watch::NewInstance(callback);
 
-	callback->start();
+	callback->start(Stats::WATCH);
 	info.GetReturnValue().Set(watch);
 }
 
 void Transaction::AddConflictRange(const FunctionCallbackInfo<Value>& info, FDBConflictRangeType type) {
+	if(!CheckByteArguments(info, 2))
+		return;
+
 	StringParams start(info[0]);
 	StringParams end(info[1]);
 
@@ -342,7 +803,7 @@ void Transaction::AddWriteConflictRange(const FunctionCallbackInfo<Value>& info)
 void Transaction::OnError(const FunctionCallbackInfo<Value>& info) {
 	fdb_error_t errorCode = info[0]->Int32Value();
 	FDBFuture *f = fdb_transaction_on_error(GetTransactionFromArgs(info), errorCode);
-	(new NodeVoidCallback(f, GetCallback(info[1])))->start();
+	(new NodeVoidCallback(f, GetCallback(info[1])))->start(Stats::ON_ERROR);
 
 	info.GetReturnValue().SetNull();
 }
@@ -362,7 +823,7 @@ void Transaction::SetReadVersion(const FunctionCallbackInfo<Value>& info) {
 
 void Transaction::GetReadVersion(const FunctionCallbackInfo<Value>& info) {
 	FDBFuture *f = fdb_transaction_get_read_version(GetTransactionFromArgs(info));
-	(new NodeVersionCallback(f, GetCallback(info[0])))->start();
+	(new NodeVersionCallback(f, GetCallback(info[0])))->start(Stats::GET_READ_VERSION);
 
 	info.GetReturnValue().SetNull();
 }
@@ -384,6 +845,9 @@ void Transaction::Cancel(const FunctionCallbackInfo<Value>& info) {
 }
 
 void Transaction::GetAddressesForKey(const FunctionCallbackInfo<Value>& info) {
+	if(!CheckByteArguments(info, 1))
+		return;
+
 	StringParams key(info[0]);
 
 	FDBFuture *f = fdb_transaction_get_addresses_for_key(GetTransactionFromArgs(info), key.str, key.len);
@@ -407,24 +871,38 @@ Handle<Value> Transaction::NewInstance(FDBTransaction *ptr) {
 	Transaction *trObj = ObjectWrap::Unwrap<Transaction>(instance);
 	trObj->tr = ptr;
 
-	instance->Set(String::NewFromUtf8(isolate, "options", String::kInternalizedString), FdbOptions::CreateOptions(FdbOptions::TransactionOption, instance));
-
 	return scope.Escape(instance);
 }
 
+// Most transactions never set an option, so the options object is only created the first time it is read
+void Transaction::GetOptions(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+	Isolate *isolate = Isolate::GetCurrent();
+	Transaction *trPtr = node::ObjectWrap::Unwrap<Transaction>(info.Holder());
+
+	if(trPtr->options.IsEmpty())
+		trPtr->options.Reset(isolate, FdbOptions::CreateOptions(FdbOptions::TransactionOption, info.Holder()));
+
+	info.GetReturnValue().Set(Local<Value>::New(isolate, trPtr->options));
+}
+
 void Transaction::Init() {
 	Isolate *isolate = Isolate::GetCurrent();
 	Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
 
 	tpl->SetClassName(String::NewFromUtf8(isolate, "Transaction", String::kInternalizedString));
 	tpl->InstanceTemplate()->SetInternalFieldCount(1);
+	tpl->InstanceTemplate()->SetAccessor(V8Cache::GetString(V8Cache::OPTIONS), GetOptions);
 
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "get", String::kInternalizedString), FunctionTemplate::New(isolate, Get)->GetFunction());
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getMany", String::kInternalizedString), FunctionTemplate::New(isolate, GetMany)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getRange", String::kInternalizedString), FunctionTemplate::New(isolate, GetRange)->GetFunction());
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getRangePacked", String::kInternalizedString), FunctionTemplate::New(isolate, GetRangePacked)->GetFunction());
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getRangeAll", String::kInternalizedString), FunctionTemplate::New(isolate, GetRangeAll)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getKey", String::kInternalizedString), FunctionTemplate::New(isolate, GetKey)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "watch", String::kInternalizedString), FunctionTemplate::New(isolate, Watch)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "set", String::kInternalizedString), FunctionTemplate::New(isolate, Set)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "commit", String::kInternalizedString), FunctionTemplate::New(isolate, Commit)->GetFunction());
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "applyMutations", String::kInternalizedString), FunctionTemplate::New(isolate, ApplyMutations)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "clear", String::kInternalizedString), FunctionTemplate::New(isolate, Clear)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "clearRange", String::kInternalizedString), FunctionTemplate::New(isolate, ClearRange)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "addReadConflictRange", String::kInternalizedString), FunctionTemplate::New(isolate, AddReadConflictRange)->GetFunction());
@@ -436,6 +914,7 @@ void Transaction::Init() {
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getCommittedVersion", String::kInternalizedString), FunctionTemplate::New(isolate, GetCommittedVersion)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "cancel", String::kInternalizedString), FunctionTemplate::New(isolate, Cancel)->GetFunction());
 	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "getAddressesForKey", String::kInternalizedString), FunctionTemplate::New(isolate, GetAddressesForKey)->GetFunction());
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "setZeroCopyResults", String::kInternalizedString), FunctionTemplate::New(isolate, SetZeroCopyResults)->GetFunction());
 
 	constructor.Reset(isolate, tpl->GetFunction());
 }
@@ -492,3 +971,107 @@ void Watch::Init() {
 
 	constructor.Reset(isolate, tpl->GetFunction());
 }
+
+// RangeSpec implementation
+RangeSpec::RangeSpec() : limit(0), mode(FDB_STREAMING_MODE_ITERATOR), iteration(1), snapshot(0), reverse(0) {
+	begin.orEqual = 0;
+	begin.offset = 1;
+	end.orEqual = 0;
+	end.offset = 1;
+};
+
+RangeSpec::~RangeSpec() { };
+
+Persistent<Function> RangeSpec::constructor;
+
+FDBFuture* RangeSpec::request(FDBTransaction *tr) {
+	return fdb_transaction_get_range(tr, (const uint8_t*)begin.key.data(), (int)begin.key.size(), begin.orEqual, begin.offset,
+										(const uint8_t*)end.key.data(), (int)end.key.size(), end.orEqual, end.offset,
+										limit, 0, mode, iteration++, snapshot, reverse);
+}
+
+bool RangeSpec::advance(const FDBKeyValue *kv, int len, fdb_bool_t more) {
+	if(limit) {
+		limit -= len;
+		if(limit <= 0)
+			more = false;
+	}
+
+	if(len > 0) {
+		const FDBKeyValue &last = kv[len - 1];
+		if(!reverse) {
+			begin.key.assign((const char*)last.key, last.key_length);
+			begin.orEqual = 1;
+			begin.offset = 1;
+		}
+		else {
+			end.key.assign((const char*)last.key, last.key_length);
+			end.orEqual = 0;
+			end.offset = 1;
+		}
+	}
+
+	return more != 0;
+}
+
+/*
+ * new RangeSpec(beginKey, beginOrEqual, beginOffset, endKey, endOrEqual, endOffset, limit, streamingMode, snapshot, reverse)
+ */
+void RangeSpec::New(const FunctionCallbackInfo<Value>& info) {
+	RangeSpec *spec = new RangeSpec();
+	spec->Wrap(info.Holder());
+
+	if(info.Length() == 0)
+		return;
+
+	if(!StringParams::Accepts(info[0]) || !StringParams::Accepts(info[3]))
+		return NanThrowTypeError("Range keys must be strings, Buffers, TypedArrays or ArrayBuffers");
+
+	StringParams begin(info[0]);
+	spec->begin.key.assign((const char*)begin.str, begin.len);
+	spec->begin.orEqual = (fdb_bool_t)info[1]->Int32Value();
+	spec->begin.offset = info[2]->Int32Value();
+
+	StringParams end(info[3]);
+	spec->end.key.assign((const char*)end.str, end.len);
+	spec->end.orEqual = (fdb_bool_t)info[4]->Int32Value();
+	spec->end.offset = info[5]->Int32Value();
+
+	spec->limit = info[6]->Int32Value();
+	spec->mode = (FDBStreamingMode)info[7]->Int32Value();
+	spec->snapshot = (fdb_bool_t)info[8]->BooleanValue();
+	spec->reverse = (fdb_bool_t)info[9]->BooleanValue();
+}
+
+/*
+ * Returns a copy of the spec that can be advanced independently, optionally with a different streaming mode
+ */
+void RangeSpec::Clone(const FunctionCallbackInfo<Value>& info) {
+	Isolate *isolate = Isolate::GetCurrent();
+	RangeSpec *spec = node::ObjectWrap::Unwrap<RangeSpec>(info.Holder());
+
+	Local<Object> instance = Local<Function>::New(isolate, constructor)->NewInstance();
+	RangeSpec *clone = node::ObjectWrap::Unwrap<RangeSpec>(instance);
+
+	clone->begin = spec->begin;
+	clone->end = spec->end;
+	clone->limit = spec->limit;
+	clone->mode = info[0]->IsNumber() ? (FDBStreamingMode)info[0]->Int32Value() : spec->mode;
+	clone->iteration = spec->iteration;
+	clone->snapshot = spec->snapshot;
+	clone->reverse = spec->reverse;
+
+	info.GetReturnValue().Set(instance);
+}
+
+void RangeSpec::Init(Handle<Object> target) {
+	Isolate *isolate = Isolate::GetCurrent();
+	Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+	tpl->SetClassName(String::NewFromUtf8(isolate, "RangeSpec", String::kInternalizedString));
+	tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+	tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, "clone", String::kInternalizedString), FunctionTemplate::New(isolate, Clone)->GetFunction());
+
+	constructor.Reset(isolate, tpl->GetFunction());
+	target->Set(String::NewFromUtf8(isolate, "RangeSpec", String::kInternalizedString), tpl->GetFunction());
+}
@@ -28,6 +28,7 @@
 
 #include <foundationdb/fdb_c.h>
 #include <node.h>
+#include <string>
 
 #include "NodeCallback.h"
 
@@ -38,12 +39,16 @@ class Transaction: public node::ObjectWrap {
 		static void New(const v8::FunctionCallbackInfo<v8::Value>& info);
 
 		static void Get(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void GetMany(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void GetKey(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void Set(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void Commit(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void Clear(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void ClearRange(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void ApplyMutations(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void GetRange(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void GetRangePacked(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void GetRangeAll(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static void Watch(const v8::FunctionCallbackInfo<v8::Value>& info);
 
 		static void AddConflictRange(const v8::FunctionCallbackInfo<v8::Value>& info, FDBConflictRangeType type);
@@ -61,6 +66,10 @@ class Transaction: public node::ObjectWrap {
 
 		static void GetAddressesForKey(const v8::FunctionCallbackInfo<v8::Value>& info);
 
+		static void SetZeroCopyResults(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+		static void GetOptions(v8::Local<v8::String> property, const v8::PropertyCallbackInfo<v8::Value>& info);
+
 		FDBTransaction* GetTransaction() { return tr; }
 	private:
 		Transaction();
@@ -68,6 +77,8 @@ class Transaction: public node::ObjectWrap {
 
 		static v8::Persistent<v8::Function> constructor;
 		FDBTransaction *tr;
+		bool zeroCopyResults;
+		v8::Persistent<v8::Value> options;
 
 		static FDBTransaction* GetTransactionFromArgs(const v8::FunctionCallbackInfo<v8::Value>& info);
 		static v8::Handle<v8::Function> GetCallback(const v8::Handle<v8::Value> funcVal);
@@ -90,4 +101,44 @@ class Watch : public node::ObjectWrap {
 		NodeCallback *callback;
 };
 
+/*
+ * Where a paged range read is up to: the selectors of the part of the range still to
+ * be read, the remaining limit and the next iteration number. A spec is created once
+ * per iterator and advanced in place as batches are read, so each request for a batch
+ * only passes the spec.
+ */
+class RangeSpec : public node::ObjectWrap {
+	public:
+		static void Init(v8::Handle<v8::Object> target);
+
+		static void New(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void Clone(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+		// Issues the request for the next batch of the range
+		FDBFuture* request(FDBTransaction *tr);
+
+		// Moves the spec past a batch that was read. Returns whether any of the range is left to read.
+		bool advance(const FDBKeyValue *kv, int len, fdb_bool_t more);
+
+		struct Selector {
+			std::string key;
+			fdb_bool_t orEqual;
+			int offset;
+		};
+
+		Selector begin;
+		Selector end;
+		int limit;
+		FDBStreamingMode mode;
+		int iteration;
+		fdb_bool_t snapshot;
+		fdb_bool_t reverse;
+
+	private:
+		RangeSpec();
+		~RangeSpec();
+
+		static v8::Persistent<v8::Function> constructor;
+};
+
 #endif
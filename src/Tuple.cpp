@@ -0,0 +1,361 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <node.h>
+#include <node_buffer.h>
+#include <nan.h>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FDB_NODE_TUPLE_SSE2
+#endif
+
+#include "Tuple.h"
+#include "V8Cache.h"
+
+using namespace v8;
+using namespace node;
+
+static const uint8_t NULL_CODE = 0x00;
+static const uint8_t BYTES_CODE = 0x01;
+static const uint8_t STRING_CODE = 0x02;
+static const uint8_t INT_ZERO_CODE = 0x14;
+
+static const double MAX_INT = 9007199254740991.0;  // 2^53 - 1
+static const uint64_t MAX_NEGATIVE_MAGNITUDE = 9007199254740992ULL;  // 2^53
+
+// Encoding happens on the node thread only, so the output is staged in reusable buffers
+static std::string packScratch;
+static std::string stringScratch;
+
+#ifdef FDB_NODE_TUPLE_SSE2
+static inline int lowestSetBit(int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns a pointer to the first 0x00 byte in [pos, end), or end if there is none
+static const uint8_t* findNullByte(const uint8_t *pos, const uint8_t *end) {
+#ifdef FDB_NODE_TUPLE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	while(end - pos >= 16) {
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)pos), zero));
+		if(mask)
+			return pos + lowestSetBit(mask);
+
+		pos += 16;
+	}
+#endif
+
+	const uint8_t *found = (const uint8_t*)memchr(pos, 0, end - pos);
+	return found ? found : end;
+}
+
+// Appends a byte string, escaping each 0x00 as 0x00 0xFF, followed by its 0x00 terminator
+static void encodeBytes(std::string &out, uint8_t code, const uint8_t *data, size_t length) {
+	const uint8_t *pos = data;
+	const uint8_t *end = data + length;
+
+	out.push_back((char)code);
+	while(pos < end) {
+		const uint8_t *nullByte = findNullByte(pos, end);
+		out.append((const char*)pos, nullByte - pos);
+		if(nullByte == end)
+			break;
+
+		out.push_back((char)0x00);
+		out.push_back((char)0xff);
+		pos = nullByte + 1;
+	}
+	out.push_back((char)0x00);
+}
+
+static bool encodeInteger(std::string &out, double value) {
+	if(value > MAX_INT || value < -MAX_INT - 1)
+		return false;
+
+	bool negative = value < 0;
+	uint64_t magnitude = (uint64_t)(negative ? -value : value);
+
+	int length = 0;
+	while(length < 8 && (magnitude >> (8 * length)) != 0)
+		++length;
+
+	out.push_back((char)(negative ? INT_ZERO_CODE - length : INT_ZERO_CODE + length));
+	for(int i = length - 1; i >= 0; --i) {
+		uint8_t b = (uint8_t)(magnitude >> (8 * i));
+		out.push_back((char)(negative ? ~b : b));
+	}
+
+	return true;
+}
+
+static bool encodeElement(std::string &out, Handle<Value> item) {
+	if(item->IsNull()) {
+		out.push_back((char)NULL_CODE);
+		return true;
+	}
+	else if(item->IsString()) {
+		Local<String> str = item->ToString();
+		int length = str->Utf8Length();
+		stringScratch.resize(length);
+		if(length > 0)
+			str->WriteUtf8(&stringScratch[0], length, NULL, String::NO_NULL_TERMINATION | String::REPLACE_INVALID_UTF8);
+
+		encodeBytes(out, STRING_CODE, (const uint8_t*)stringScratch.data(), length);
+		return true;
+	}
+	else if(Buffer::HasInstance(item)) {
+		Local<Object> obj = item->ToObject();
+		encodeBytes(out, BYTES_CODE, (const uint8_t*)Buffer::Data(obj), Buffer::Length(obj));
+		return true;
+	}
+	else if(item->IsNumber()) {
+		double value = item->NumberValue();
+		if(value != value || floor(value) != value)  // NaN, infinite or not an integer
+			return false;
+
+		return encodeInteger(out, value);
+	}
+
+	return false;
+}
+
+static bool encodeTuple(std::string &out, Handle<Value> arrVal) {
+	if(!arrVal->IsArray())
+		return false;
+
+	Local<Array> arr = Local<Array>::Cast(arrVal);
+	uint32_t length = arr->Length();
+	for(uint32_t i = 0; i < length; ++i) {
+		if(!encodeElement(out, arr->Get(i)))
+			return false;
+	}
+
+	return true;
+}
+
+// The optional prefix argument of Pack and Range, which is written ahead of the encoded tuple
+struct Prefix {
+	const char *data;
+	size_t length;
+
+	Prefix(const FunctionCallbackInfo<Value>& info, int index) : data(NULL), length(0) {
+		if(info.Length() > index && Buffer::HasInstance(info[index])) {
+			Local<Object> obj = info[index]->ToObject();
+			data = Buffer::Data(obj);
+			length = Buffer::Length(obj);
+		}
+	}
+};
+
+static Local<Object> makeBuffer(const Prefix &prefix, const std::string &data, const char *suffix, size_t suffixLength) {
+	Isolate *isolate = Isolate::GetCurrent();
+	Local<Object> buf = Buffer::New(isolate, prefix.length + data.size() + suffixLength);
+	char *pos = Buffer::Data(buf);
+
+	if(prefix.length > 0)
+		memcpy(pos, prefix.data, prefix.length);
+	memcpy(pos + prefix.length, data.data(), data.size());
+	if(suffixLength > 0)
+		memcpy(pos + prefix.length + data.size(), suffix, suffixLength);
+
+	return buf;
+}
+
+// Takes an array and an optional prefix buffer, and returns one buffer holding the prefix followed by the packed tuple
+void Tuple::Pack(const FunctionCallbackInfo<Value>& info) {
+	packScratch.clear();
+	if(!encodeTuple(packScratch, info[0]))
+		return info.GetReturnValue().SetUndefined();
+
+	info.GetReturnValue().Set(makeBuffer(Prefix(info, 1), packScratch, NULL, 0));
+}
+
+/*
+ * Takes an array, a target buffer and an offset into it. The packed tuple is written
+ * to the target at the offset, and the number of bytes written is returned, or -1 if
+ * the tuple does not fit.
+ */
+void Tuple::PackInto(const FunctionCallbackInfo<Value>& info) {
+	packScratch.clear();
+	if(!Buffer::HasInstance(info[1]) || !encodeTuple(packScratch, info[0]))
+		return info.GetReturnValue().SetUndefined();
+
+	Local<Object> target = info[1]->ToObject();
+	size_t targetLength = Buffer::Length(target);
+	size_t offset = info[2]->Uint32Value();
+
+	if(offset > targetLength || packScratch.size() > targetLength - offset)
+		return info.GetReturnValue().Set(-1);
+
+	memcpy(Buffer::Data(target) + offset, packScratch.data(), packScratch.size());
+	info.GetReturnValue().Set((uint32_t)packScratch.size());
+}
+
+void Tuple::Range(const FunctionCallbackInfo<Value>& info) {
+	Isolate *isolate = Isolate::GetCurrent();
+
+	packScratch.clear();
+	if(!encodeTuple(packScratch, info[0]))
+		return info.GetReturnValue().SetUndefined();
+
+	Prefix prefix(info, 1);
+
+	Local<Object> range = Object::New(isolate);
+	range->Set(V8Cache::GetString(V8Cache::BEGIN), makeBuffer(prefix, packScratch, "\x00", 1));
+	range->Set(V8Cache::GetString(V8Cache::END), makeBuffer(prefix, packScratch, "\xff", 1));
+
+	info.GetReturnValue().Set(range);
+}
+
+/*
+ * Finds the terminator of the byte string starting at pos: the first 0x00 that is
+ * not followed by 0xFF. A missing terminator is treated as the end of the key.
+ * Sets escapes to the number of escaped 0x00 bytes before the terminator.
+ */
+static const uint8_t* findTerminator(const uint8_t *pos, const uint8_t *end, size_t &escapes) {
+	escapes = 0;
+	while(true) {
+		const uint8_t *nullByte = findNullByte(pos, end);
+		if(nullByte + 1 >= end || nullByte[1] != 0xff)
+			return nullByte;
+
+		++escapes;
+		pos = nullByte + 2;
+	}
+}
+
+static bool decodeElement(const uint8_t *&pos, const uint8_t *end, Local<Value> &out) {
+	Isolate *isolate = Isolate::GetCurrent();
+	uint8_t code = *pos;
+
+	if(code == NULL_CODE) {
+		out = Null(isolate);
+		++pos;
+	}
+	else if(code == BYTES_CODE || code == STRING_CODE) {
+		const uint8_t *start = pos + 1;
+		size_t escapes;
+		const uint8_t *terminator = findTerminator(start, end, escapes);
+
+		const char *data = (const char*)start;
+		size_t length = terminator - start;
+		if(escapes > 0) {
+			stringScratch.clear();
+			const uint8_t *segment = start;
+			while(segment < terminator) {
+				const uint8_t *nullByte = findNullByte(segment, terminator);
+				stringScratch.append((const char*)segment, nullByte - segment);
+				if(nullByte == terminator)
+					break;
+
+				stringScratch.push_back((char)0x00);
+				segment = nullByte + 2;
+			}
+
+			data = stringScratch.data();
+			length = stringScratch.size();
+		}
+
+		if(code == STRING_CODE)
+			out = String::NewFromUtf8(isolate, data, String::kNormalString, (int)length);
+		else {
+			Local<Object> buf = Buffer::New(isolate, length);
+			memcpy(Buffer::Data(buf), data, length);
+			out = buf;
+		}
+
+		pos = terminator == end ? end : terminator + 1;
+	}
+	else if(code >= INT_ZERO_CODE - 7 && code <= INT_ZERO_CODE + 7) {
+		bool negative = code < INT_ZERO_CODE;
+		int length = negative ? INT_ZERO_CODE - code : code - INT_ZERO_CODE;
+		if(end - pos - 1 < length)
+			return false;
+
+		uint64_t magnitude = 0;
+		for(int i = 1; i <= length; ++i)
+			magnitude = (magnitude << 8) | (uint8_t)(negative ? ~pos[i] : pos[i]);
+
+		if(magnitude > (negative ? MAX_NEGATIVE_MAGNITUDE : MAX_NEGATIVE_MAGNITUDE - 1))
+			return false;
+
+		out = Number::New(isolate, negative ? -(double)magnitude : (double)magnitude);
+		pos += length + 1;
+	}
+	else
+		return false;
+
+	return true;
+}
+
+void Tuple::Unpack(const FunctionCallbackInfo<Value>& info) {
+	Isolate *isolate = Isolate::GetCurrent();
+
+	if(!Buffer::HasInstance(info[0]))
+		return info.GetReturnValue().SetUndefined();
+
+	Local<Object> key = info[0]->ToObject();
+	const uint8_t *pos = (const uint8_t*)Buffer::Data(key);
+	const uint8_t *end = pos + Buffer::Length(key);
+
+	// Decoding can start part way into the key, e.g. after the prefix of a subspace
+	if(info.Length() > 1 && info[1]->IsNumber())
+		pos += std::min((size_t)info[1]->Uint32Value(), (size_t)(end - pos));
+
+	Local<Array> arr = Array::New(isolate);
+	uint32_t index = 0;
+	while(pos < end) {
+		Local<Value> value;
+		if(!decodeElement(pos, end, value))
+			return info.GetReturnValue().SetUndefined();
+
+		arr->Set(index++, value);
+	}
+
+	info.GetReturnValue().Set(arr);
+}
+
+// Takes two buffers and returns whether the first begins with the second
+void Tuple::StartsWith(const FunctionCallbackInfo<Value>& info) {
+	if(!Buffer::HasInstance(info[0]) || !Buffer::HasInstance(info[1]))
+		return info.GetReturnValue().SetUndefined();
+
+	Local<Object> key = info[0]->ToObject();
+	Local<Object> prefix = info[1]->ToObject();
+	size_t prefixLength = Buffer::Length(prefix);
+
+	bool result = Buffer::Length(key) >= prefixLength && memcmp(Buffer::Data(key), Buffer::Data(prefix), prefixLength) == 0;
+	info.GetReturnValue().Set(result);
+}
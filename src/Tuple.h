@@ -0,0 +1,51 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FDB_NODE_TUPLE_H
+#define FDB_NODE_TUPLE_H
+
+#include "Version.h"
+
+#include <node.h>
+
+/*
+ * Native implementation of the tuple layer encoding. Each function returns
+ * undefined for input it does not handle (unsupported element types, values
+ * out of range or malformed keys), in which case lib/tuple.js falls back to
+ * its JavaScript implementation to produce the result or the error.
+ */
+class Tuple {
+	public:
+		static void Pack(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void Unpack(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void Range(const v8::FunctionCallbackInfo<v8::Value>& info);
+		static void PackInto(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+		// Prefix comparison of two buffers, used by Subspace.contains
+		static void StartsWith(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+	private:
+		Tuple();  // not implemented by design
+};
+
+#endif
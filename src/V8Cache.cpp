@@ -0,0 +1,63 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <node.h>
+
+#include "V8Cache.h"
+
+using namespace v8;
+
+Persistent<String> V8Cache::strings[V8Cache::NAME_COUNT];
+Persistent<ObjectTemplate> V8Cache::keyValueTemplate;
+
+static const char *names[V8Cache::NAME_COUNT] = {
+	"key",
+	"value",
+	"array",
+	"more",
+	"buffer",
+	"offsets",
+	"options",
+	"begin",
+	"end"
+};
+
+void V8Cache::Init() {
+	Isolate *isolate = Isolate::GetCurrent();
+
+	for(int i = 0; i < NAME_COUNT; i++)
+		strings[i].Reset(isolate, String::NewFromUtf8(isolate, names[i], String::kInternalizedString));
+
+	Local<ObjectTemplate> tpl = ObjectTemplate::New(isolate);
+	tpl->Set(GetString(KEY), Null(isolate));
+	tpl->Set(GetString(VALUE), Null(isolate));
+	keyValueTemplate.Reset(isolate, tpl);
+}
+
+Local<String> V8Cache::GetString(Name name) {
+	return Local<String>::New(Isolate::GetCurrent(), strings[name]);
+}
+
+Local<ObjectTemplate> V8Cache::GetKeyValueTemplate() {
+	return Local<ObjectTemplate>::New(Isolate::GetCurrent(), keyValueTemplate);
+}
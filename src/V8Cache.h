@@ -0,0 +1,64 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FDB_NODE_V8_CACHE_H
+#define FDB_NODE_V8_CACHE_H
+
+#include "Version.h"
+
+#include <node.h>
+
+/*
+ * Internalized strings and templates used on hot paths, created once when the
+ * module loads instead of every time a result is converted.
+ */
+class V8Cache {
+	public:
+		enum Name {
+			KEY,
+			VALUE,
+			ARRAY,
+			MORE,
+			BUFFER,
+			OFFSETS,
+			OPTIONS,
+			BEGIN,
+			END,
+			NAME_COUNT
+		};
+
+		static void Init();
+
+		static v8::Local<v8::String> GetString(Name name);
+
+		// Instances start with key and value properties, so every KeyValue shares one hidden class
+		static v8::Local<v8::ObjectTemplate> GetKeyValueTemplate();
+
+	private:
+		V8Cache();  // not implemented by design
+
+		static v8::Persistent<v8::String> strings[NAME_COUNT];
+		static v8::Persistent<v8::ObjectTemplate> keyValueTemplate;
+};
+
+#endif
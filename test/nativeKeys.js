@@ -0,0 +1,127 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+/*
+ * Checks how the native transaction reads keys and values that are not Buffers.
+ * Needs the built addon and, like the benchmarks, either a cluster or the in-memory
+ * stand-in for libfdb_c:
+ *
+ *   node-gyp rebuild -- -Dfdb_c_fake=1
+ *   node test/nativeKeys.js
+ *
+ * Writes to keys starting with 'test/nativeKeys/'.
+ */
+
+var assert = require('assert');
+
+var fdb = require('../lib/fdb').apiVersion(300);
+var db = fdb.open();
+
+var prefix = new Buffer('test/nativeKeys/');
+
+function bytes(str) {
+	return Buffer.concat([prefix, new Buffer(str)]);
+}
+
+// Views over their own copy of the key, well under the size V8 keeps on its heap
+function uint8Array(buf) {
+	var arr = new Uint8Array(buf.length);
+	for(var i = 0; i < buf.length; ++i)
+		arr[i] = buf[i];
+	return arr;
+}
+
+var tests = [
+	function shortUint8ArrayKey(done) {
+		var key = bytes('u8');
+		db.set(uint8Array(key), uint8Array(new Buffer('short')), function(err) {
+			assert.ifError(err);
+			db.get(key, function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'short');
+				db.get(uint8Array(key), function(err, value) {
+					assert.ifError(err);
+					assert.equal(value.toString(), 'short');
+					done();
+				});
+			});
+		});
+	},
+
+	function uint8ArrayAtOffset(done) {
+		var key = bytes('offset');
+		var padded = uint8Array(Buffer.concat([new Buffer('xx'), key, new Buffer('yy')]));
+		db.set(padded.subarray(2, 2 + key.length), 'v', function(err) {
+			assert.ifError(err);
+			db.get(key, function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'v');
+				done();
+			});
+		});
+	},
+
+	function shortUint8ArrayClears(done) {
+		db.doTransaction(function(tr, innerCb) {
+			tr.set(bytes('clear/a'), '1');
+			tr.set(bytes('clear/b'), '2');
+			tr.set(bytes('clear/c'), '3');
+			tr.clear(uint8Array(bytes('clear/a')));
+			tr.clearRange(uint8Array(bytes('clear/b')), uint8Array(bytes('clear/c')));
+			innerCb();
+		}, function(err) {
+			assert.ifError(err);
+			db.getRangeStartsWith(bytes('clear/'), {}, function(err, kvs) {
+				assert.ifError(err);
+				assert.deepEqual(kvs.map(function(kv) { return kv.value.toString(); }), ['3']);
+				done();
+			});
+		});
+	},
+
+	function rejectsOtherTypes(done) {
+		var tr = db.createTransaction();
+		assert.throws(function() { tr.tr.get(5, false, function() {}); }, TypeError);
+		assert.throws(function() { tr.tr.set(bytes('n'), {}); }, TypeError);
+		assert.throws(function() { tr.tr.clear(undefined); }, TypeError);
+		assert.throws(function() { tr.tr.clearRange(bytes('a'), null); }, TypeError);
+		assert.throws(function() { tr.tr.addReadConflictRange(1, 2); }, TypeError);
+		done();
+	}
+];
+
+db.clearRangeStartsWith(prefix, function(err) {
+	assert.ifError(err);
+
+	var index = 0;
+	(function next() {
+		if(index === tests.length) {
+			console.log('nativeKeys: ' + tests.length + ' tests passed');
+			process.exit(0);
+		}
+
+		tests[index++](next);
+	})();
+});
@@ -0,0 +1,153 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+// Runs against a stub of the native module, so no cluster is needed
+
+var assert = require('assert');
+var path = require('path');
+
+var modulePath = path.join(__dirname, '..', 'lib', 'fdbModule.js');
+require.cache[modulePath] = {
+	id: modulePath,
+	filename: modulePath,
+	loaded: true,
+	exports: {
+		streamingMode: { iterator: -1 },
+		atomic: {},
+		options: {},
+		RangeSpec: function() {},
+		startsWith: function() {},
+		tuplePack: function() {},
+		tuplePackInto: function() {},
+		tupleUnpack: function() {},
+		tupleRange: function() {}
+	}
+};
+
+var Database = require('../lib/database');
+
+var created = 0;
+var nativeDatabase = {
+	options: {},
+	createTransaction: function() {
+		var id = ++created;
+		return {
+			id: id,
+			reset: function() {},
+			set: function() {},
+			// Range reads stay outstanding, like a prefetch that outlives the transaction
+			getRange: function() {},
+			commit: function(cb) { setImmediate(cb); },
+			watch: function() { return { cancel: function() {} }; }
+		};
+	}
+};
+
+var db = new Database(nativeDatabase);
+db.setTransactionPoolSize(4);
+
+// Runs a transaction that calls use(tr) and returns the id of its native transaction
+function run(use, cb) {
+	var id;
+	db.doTransaction(function(tr, innerCb) {
+		id = tr.tr.id;
+		use(tr);
+		tr.set('k', 'v');
+		innerCb();
+	}, function(err) {
+		assert.ifError(err);
+		cb(id);
+	});
+}
+
+var tests = [
+	function reusesFinishedTransactions(done) {
+		run(function() {}, function(first) {
+			setImmediate(function() {
+				run(function() {}, function(second) {
+					assert.strictEqual(second, first);
+					done();
+				});
+			});
+		});
+	},
+
+	function releasesAfterCallbackReturns(done) {
+		run(function() {}, function(first) {
+			// Still inside the callback, so the transaction has not been released yet
+			run(function() {}, function(second) {
+				assert.notStrictEqual(second, first);
+				done();
+			});
+		});
+	},
+
+	function doesNotReuseAfterRangeRead(done) {
+		run(function(tr) { tr.getRange('a', 'b'); }, function(first) {
+			setImmediate(function() {
+				run(function() {}, function(second) {
+					assert.notStrictEqual(second, first);
+					done();
+				});
+			});
+		});
+	},
+
+	function doesNotReuseAfterSnapshotRangeRead(done) {
+		run(function(tr) { tr.snapshot.getRangeStartsWith('a'); }, function(first) {
+			setImmediate(function() {
+				run(function() {}, function(second) {
+					assert.notStrictEqual(second, first);
+					done();
+				});
+			});
+		});
+	},
+
+	function doesNotReuseAfterWatch(done) {
+		run(function(tr) { tr.watch('k'); }, function(first) {
+			setImmediate(function() {
+				run(function() {}, function(second) {
+					assert.notStrictEqual(second, first);
+					done();
+				});
+			});
+		});
+	}
+];
+
+function runTest(index) {
+	if(index === tests.length) {
+		console.log('transactionPool: ' + tests.length + ' tests passed');
+		return;
+	}
+
+	db._transactionPool.length = 0;
+	tests[index](function() {
+		runTest(index + 1);
+	});
+}
+
+runTest(0);
@@ -0,0 +1,120 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+// Checks the compiled tuple codecs against the generic tuple functions, without the addon
+
+var assert = require('assert');
+var path = require('path');
+
+var modulePath = path.join(__dirname, '..', 'lib', 'fdbModule.js');
+require.cache[modulePath] = {
+	id: modulePath,
+	filename: modulePath,
+	loaded: true,
+	exports: {
+		startsWith: function() {},
+		tuplePack: function() {},
+		tuplePackInto: function() {},
+		tupleUnpack: function() {},
+		tupleRange: function() {}
+	}
+};
+
+var tuple = require('../lib/tuple');
+
+function error(func) {
+	try {
+		func();
+	}
+	catch(e) {
+		return e;
+	}
+
+	assert.fail('expected an error');
+}
+
+var tests = [
+	function packsLikePack() {
+		var codec = tuple.compile(['string', 'bytes', 'int']);
+		var values = [['', '', 0], ['a\u0000b', 'x\u0000', -1], ['é中', new Buffer([0, 0xff]), Math.pow(2, 53) - 1], ['z', new Buffer(0), -Math.pow(2, 53)]];
+		values.forEach(function(arr) {
+			var expected = tuple.pack([arr[0], typeof arr[1] === 'string' ? new Buffer(arr[1]) : arr[1], arr[2]]);
+			assert.deepEqual(codec.pack(arr), expected);
+
+			var prefix = new Buffer('p');
+			assert.deepEqual(codec.pack(arr, prefix), Buffer.concat([prefix, expected]));
+
+			var target = new Buffer(expected.length + 2);
+			assert.equal(codec.packInto(arr, target, 2), expected.length);
+			assert.deepEqual(target.slice(2), expected);
+			assert.equal(codec.packInto(arr, target, 3), -1);
+		});
+	},
+
+	function convertsBytesOnce() {
+		var codec = tuple.compile([{ name: 'data', type: 'bytes' }]);
+		var conversions = 0;
+		var original = codec.converters[0];
+		codec.converters[0] = function(item) {
+			++conversions;
+			return original(item);
+		};
+
+		codec.pack({ data: 'abc' });
+		assert.equal(conversions, 1);
+		assert.deepEqual(codec.items, [undefined]);
+	},
+
+	function unpacksLikeUnpack() {
+		var codec = tuple.compile(['string', 'bytes', 'int']);
+		var key = tuple.pack(['a\u0000b', new Buffer([0, 1]), -70000]);
+		assert.deepEqual(codec.unpack(key), tuple.unpack(key));
+	},
+
+	function rejectsEightByteIntegersLikeUnpack() {
+		var codec = tuple.compile(['int']);
+		[0x1c, 0x0c].forEach(function(code) {
+			var key = new Buffer([code, 0, 0, 0, 0, 0, 0, 0, 1]);
+			var expected = error(function() { tuple.unpack(key); });
+			var actual = error(function() { codec.unpack(key); });
+
+			assert(expected instanceof RangeError);
+			assert.strictEqual(actual.constructor, expected.constructor);
+			assert.strictEqual(actual.message, expected.message);
+		});
+	},
+
+	function rejectsOtherTypes() {
+		var codec = tuple.compile(['int']);
+		assert.throws(function() { codec.unpack(tuple.pack(['a'])); }, TypeError);
+		assert.throws(function() { codec.unpack(tuple.pack([1, 2])); }, TypeError);
+	}
+];
+
+tests.forEach(function(test) {
+	test();
+});
+
+console.log('tupleCodec: ' + tests.length + ' tests passed');
@@ -0,0 +1,273 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+/*
+ * Checks that the native tuple codec and the JavaScript implementation in lib/tuple.js
+ * agree: every operation must produce the same bytes (or values), or throw the same
+ * error, on randomized and edge case inputs. Needs the built addon.
+ *
+ *   node test/tupleParity.js [iterations] [seed]
+ */
+
+var assert = require('assert');
+var path = require('path');
+
+var libPath = path.join(__dirname, '..', 'lib');
+var modulePath = path.join(libPath, 'fdbModule.js');
+
+try {
+	require(modulePath);
+}
+catch(e) {
+	console.error('tupleParity: the native module is not built (' + e.message + ')');
+	process.exit(1);
+}
+
+var nativeTuple = require('../lib/tuple');
+
+// A second copy of the tuple layer, loaded against a native module that declines everything
+var reloaded = ['tuple.js', 'fdbUtil.js'].map(function(file) { return path.join(libPath, file); });
+var saved = [modulePath].concat(reloaded).map(function(file) { return require.cache[file]; });
+
+reloaded.forEach(function(file) { delete require.cache[file]; });
+require.cache[modulePath] = {
+	id: modulePath,
+	filename: modulePath,
+	loaded: true,
+	exports: {
+		startsWith: function() {},
+		tuplePack: function() {},
+		tuplePackInto: function() {},
+		tupleUnpack: function() {},
+		tupleRange: function() {}
+	}
+};
+
+var jsTuple = require('../lib/tuple');
+
+[modulePath].concat(reloaded).forEach(function(file, i) { require.cache[file] = saved[i]; });
+
+assert.notStrictEqual(nativeTuple, jsTuple);
+
+var iterations = parseInt(process.argv[2], 10) || 10000;
+var seed = parseInt(process.argv[3], 10) || (Date.now() % 0x7fffffff) || 1;
+
+// Park-Miller, so that a failing seed can be replayed
+var state = seed;
+function random() {
+	state = (state * 48271) % 0x7fffffff;
+	return state / 0x7fffffff;
+}
+
+function randomInt(n) {
+	return Math.floor(random() * n);
+}
+
+function choose(arr) {
+	return arr[randomInt(arr.length)];
+}
+
+var integerBoundaries = [0, 1, -1, Math.pow(2, 53) - 1, -Math.pow(2, 53) + 1, Math.pow(2, 53), -Math.pow(2, 53)];
+for(var bytes = 1; bytes <= 7; ++bytes) {
+	var limit = Math.pow(2, 8 * bytes);
+	integerBoundaries.push(limit - 1, limit, limit + 1, -limit + 1, -limit, -limit - 1);
+}
+
+var stringParts = ['', 'a', 'foo', '\x00', '\x00\x00', '\xff', '\x01', 'é', '中文', '😀', 'z\x00z'];
+
+function randomBytes(length) {
+	var buf = new Buffer(length);
+	var fill = choose(['random', 'zero', 'ff', 'mixed']);
+	for(var i = 0; i < length; ++i) {
+		if(fill === 'zero')
+			buf[i] = 0;
+		else if(fill === 'ff')
+			buf[i] = 0xff;
+		else if(fill === 'mixed')
+			buf[i] = choose([0x00, 0xff, 0x01, 0x02]);
+		else
+			buf[i] = randomInt(256);
+	}
+	return buf;
+}
+
+function randomString() {
+	var str = '';
+	var parts = randomInt(6);
+	for(var i = 0; i < parts; ++i) {
+		if(random() < 0.7)
+			str += choose(stringParts);
+		else
+			str += String.fromCharCode(randomInt(0x10000));
+	}
+	return str;
+}
+
+function randomInteger() {
+	if(random() < 0.5)
+		return choose(integerBoundaries);
+
+	var magnitude = Math.floor(random() * Math.pow(2, randomInt(54)));
+	return random() < 0.5 ? -magnitude : magnitude;
+}
+
+function randomElement(allowInvalid) {
+	var r = random();
+	if(allowInvalid && r < 0.03)
+		return choose([1.5, NaN, Infinity, true, {}, undefined, [1, null], ['x']]);
+	else if(r < 0.2)
+		return null;
+	else if(r < 0.45)
+		return randomString();
+	else if(r < 0.7)
+		return randomBytes(randomInt(12));
+	else
+		return randomInteger();
+}
+
+function randomTuple(allowInvalid) {
+	var arr = [];
+	var length = randomInt(8);
+	for(var i = 0; i < length; ++i)
+		arr.push(randomElement(allowInvalid));
+	return arr;
+}
+
+// Packed keys with bytes flipped, cut short or appended, plus plain noise
+function randomKey() {
+	var r = random();
+	if(r < 0.25)
+		return randomBytes(randomInt(16));
+
+	var key;
+	while(!key)
+		key = run(function() { return jsTuple.pack(randomTuple(false)); }).value;
+
+	if(r < 0.5)
+		return key;
+	else if(r < 0.7)
+		return key.slice(0, randomInt(key.length + 1));
+	else if(r < 0.85) {
+		key = new Buffer(key);
+		if(key.length > 0)
+			key[randomInt(key.length)] = randomInt(256);
+		return key;
+	}
+	else
+		return Buffer.concat([key, new Buffer([choose([0x00, 0x01, 0x02, 0x0b, 0x1c, 0x1d, 0x1f, 0x30, 0xff])])]);
+}
+
+function describe(value) {
+	if(Buffer.isBuffer(value))
+		return '<Buffer ' + value.toString('hex') + '>';
+	else if(value instanceof Array)
+		return '[' + value.map(describe).join(', ') + ']';
+	else if(typeof value === 'string')
+		return JSON.stringify(value);
+	else if(value && typeof value === 'object')
+		return '{' + Object.keys(value).map(function(k) { return k + ': ' + describe(value[k]); }).join(', ') + '}';
+	else
+		return String(value);
+}
+
+function run(func) {
+	try {
+		return { value: func() };
+	}
+	catch(e) {
+		return { error: e };
+	}
+}
+
+var checks = 0;
+
+function check(name, args, nativeFunc, jsFunc) {
+	var expected = run(jsFunc);
+	var actual = run(nativeFunc);
+	++checks;
+
+	var context = name + '(' + args.map(describe).join(', ') + ') with seed ' + seed;
+	if(expected.error || actual.error) {
+		assert(expected.error && actual.error, context + ': native ' + describe(actual.value || actual.error) + ', JavaScript ' + describe(expected.value || expected.error));
+		assert.strictEqual(actual.error.constructor, expected.error.constructor, context + ': ' + actual.error + ' vs ' + expected.error);
+		assert.strictEqual(actual.error.message, expected.error.message, context);
+	}
+	else {
+		assert.deepEqual(actual.value, expected.value, context + ': native ' + describe(actual.value) + ', JavaScript ' + describe(expected.value));
+		assert.strictEqual(describe(actual.value), describe(expected.value), context);
+	}
+}
+
+function checkTuple(arr) {
+	var prefix = randomBytes(randomInt(4));
+
+	check('pack', [arr], function() { return nativeTuple.pack(arr); }, function() { return jsTuple.pack(arr); });
+	check('packWithPrefix', [prefix, arr], function() { return nativeTuple.packWithPrefix(prefix, arr); }, function() { return jsTuple.packWithPrefix(prefix, arr); });
+	check('range', [arr], function() { return nativeTuple.range(arr); }, function() { return jsTuple.range(arr); });
+	check('rangeWithPrefix', [prefix, arr], function() { return nativeTuple.rangeWithPrefix(prefix, arr); }, function() { return jsTuple.rangeWithPrefix(prefix, arr); });
+
+	var size = randomInt(48);
+	var offset = randomInt(size + 2);
+	var nativeTarget = randomBytes(size);
+	var jsTarget = new Buffer(nativeTarget);
+	check('packInto', [arr, size, offset], function() {
+		return { length: nativeTuple.packInto(arr, nativeTarget, offset), target: nativeTarget };
+	}, function() {
+		return { length: jsTuple.packInto(arr, jsTarget, offset), target: jsTarget };
+	});
+}
+
+function checkKey(key) {
+	var offset = randomInt(key.length + 1);
+
+	check('unpack', [key], function() { return nativeTuple.unpack(key); }, function() { return jsTuple.unpack(key); });
+	check('unpackFrom', [key, offset], function() { return nativeTuple.unpackFrom(key, offset); }, function() { return jsTuple.unpackFrom(key, offset); });
+}
+
+integerBoundaries.forEach(function(n) {
+	checkTuple([n]);
+	checkTuple([null, n, null]);
+});
+
+stringParts.forEach(function(str) {
+	checkTuple([str]);
+	checkTuple([new Buffer(str, 'binary')]);
+});
+
+checkTuple([]);
+checkTuple([null, [null], null]);
+checkTuple([new Buffer([0, 0, 0xff, 0xff, 0])]);
+checkTuple('not an array');
+
+[[], [0x15], [0x1c, 1, 2, 3, 4, 5, 6, 7, 8], [0x0c, 0, 0, 0, 0, 0, 0, 0, 0], [0x01, 0x61], [0x02, 0x00, 0xff], [0x03], [0x1b, 0xff]].forEach(function(bytes) {
+	checkKey(new Buffer(bytes));
+});
+
+for(var i = 0; i < iterations; ++i) {
+	checkTuple(randomTuple(true));
+	checkKey(randomKey());
+}
+
+console.log('tupleParity: ' + checks + ' checks passed (seed ' + seed + ')');
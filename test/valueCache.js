@@ -0,0 +1,216 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+// Runs against a stub of the native module, so no cluster is needed. The stub
+// declines every tuple call, leaving tuples to the JavaScript codec.
+
+var assert = require('assert');
+var path = require('path');
+
+var modulePath = path.join(__dirname, '..', 'lib', 'fdbModule.js');
+require.cache[modulePath] = {
+	id: modulePath,
+	filename: modulePath,
+	loaded: true,
+	exports: {
+		streamingMode: { iterator: -1 },
+		atomic: {},
+		options: {},
+		startsWith: function() {},
+		tuplePack: function() {},
+		tuplePackInto: function() {},
+		tupleUnpack: function() {},
+		tupleRange: function() {}
+	}
+};
+
+var Database = require('../lib/database');
+var Subspace = require('../lib/subspace');
+
+var store = {};
+var watches = [];
+var reads = 0;
+var version = 5;
+
+var nativeDatabase = {
+	options: {},
+	createTransaction: function() {
+		var pendingWatches = [];
+		return {
+			reset: function() {},
+			getReadVersion: function(cb) {
+				var v = version;
+				setImmediate(function() { cb(null, v); });
+			},
+			get: function(key, snapshot, cb) {
+				++reads;
+				var value = store[key.toString('hex')] || null;
+				setImmediate(function() { cb(null, value); });
+			},
+			watch: function(key, cb) {
+				var w = { key: key.toString('hex'), cb: cb, cancel: function() { w.cancelled = true; } };
+				pendingWatches.push(w);
+				return w;
+			},
+			addReadConflictRange: function() {},
+			commit: function(cb) {
+				watches = watches.concat(pendingWatches);
+				setImmediate(cb);
+			}
+		};
+	}
+};
+
+var db = new Database(nativeDatabase);
+var subspace = new Subspace(['cfg']);
+
+function set(key, value) {
+	store[subspace.pack([key]).toString('hex')] = new Buffer(value);
+}
+
+function entryVersion(cache, key) {
+	return cache._entries[subspace.pack([key]).toString('binary')].version;
+}
+
+var tests = [
+	function hitsAfterFill(cache, done) {
+		set('a', 'A');
+		cache.get(['a'], function(err, value) {
+			assert.ifError(err);
+			assert.equal(value.toString(), 'A');
+			var before = reads;
+			cache.get(['a'], function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'A');
+				assert.equal(reads, before);
+				done();
+			});
+		});
+	},
+
+	function dropsEntryWhenWatchFires(cache, done) {
+		set('a', 'A');
+		cache.get(['a'], function(err) {
+			assert.ifError(err);
+			set('a', 'B');
+			watches[watches.length - 1].cb(null);
+			setImmediate(function() {
+				assert.equal(cache.size, 0);
+				cache.get(['a'], function(err, value) {
+					assert.ifError(err);
+					assert.equal(value.toString(), 'B');
+					done();
+				});
+			});
+		});
+	},
+
+	function evictsLeastRecentlyUsed(cache, done) {
+		cache.get(['a'], function() {
+			cache.get(['b'], function() {
+				cache.get(['c'], function() {
+					assert.equal(cache.size, 2);
+					assert.equal(watches.filter(function(w) { return w.cancelled; }).length, 1);
+					done();
+				});
+			});
+		});
+	},
+
+	function hitsAtSameReadVersion(cache, done) {
+		set('a', 'A');
+		cache.get(['a'], function(err) {
+			assert.ifError(err);
+			var before = reads;
+			cache.getInTransaction(db.createTransaction(), ['a'], function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'A');
+				assert.equal(reads, before);
+				done();
+			});
+		});
+	},
+
+	function readsThroughWhenEntryIsNewer(cache, done) {
+		set('a', 'A');
+		version = 9;
+		cache.get(['a'], function(err) {
+			assert.ifError(err);
+			assert.equal(entryVersion(cache, 'a'), 9);
+
+			// The value at version 5 is not in the cache, even though the entry is current
+			set('a', 'old');
+			version = 5;
+			var before = reads;
+			cache.getInTransaction(db.createTransaction(), ['a'], function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'old');
+				assert.equal(reads, before + 1);
+				assert.equal(entryVersion(cache, 'a'), 9);
+				done();
+			});
+		});
+	},
+
+	function readsThroughAndRefreshesWhenEntryIsOlder(cache, done) {
+		set('a', 'A');
+		cache.get(['a'], function(err) {
+			assert.ifError(err);
+			version = 7;
+			var before = reads;
+			cache.getInTransaction(db.createTransaction(), ['a'], function(err, value) {
+				assert.ifError(err);
+				assert.equal(value.toString(), 'A');
+				assert.equal(reads, before + 1);
+				assert.equal(entryVersion(cache, 'a'), 7);
+				cache.getInTransaction(db.createTransaction(), ['a'], function(err, value) {
+					assert.ifError(err);
+					assert.equal(value.toString(), 'A');
+					assert.equal(reads, before + 1);
+					done();
+				});
+			});
+		});
+	}
+];
+
+function runTest(index) {
+	if(index === tests.length) {
+		console.log('valueCache: ' + tests.length + ' tests passed');
+		return;
+	}
+
+	store = {};
+	watches = [];
+	version = 5;
+
+	var cache = db.cache(subspace, { maxEntries: 2 });
+	tests[index](cache, function() {
+		cache.clear();
+		runTest(index + 1);
+	});
+}
+
+runTest(0);
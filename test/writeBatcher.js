@@ -0,0 +1,148 @@
+/*
+ * FoundationDB Node.js API
+ * Copyright (c) 2012 FoundationDB, LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"use strict";
+
+// Runs against a stub of the native module, so no cluster is needed
+
+var assert = require('assert');
+var path = require('path');
+
+var modulePath = path.join(__dirname, '..', 'lib', 'fdbModule.js');
+require.cache[modulePath] = {
+	id: modulePath,
+	filename: modulePath,
+	loaded: true,
+	exports: {
+		streamingMode: { iterator: -1 },
+		atomic: {},
+		options: {},
+		startsWith: function() {},
+		tuplePack: function() {},
+		tuplePackInto: function() {},
+		tupleUnpack: function() {},
+		tupleRange: function() {}
+	}
+};
+
+var Database = require('../lib/database');
+var FDBError = require('../lib/error');
+
+// Commits fail with key_outside_legal_range if any write mentions 'bad'
+var commits = [];
+var nativeDatabase = {
+	options: {},
+	createTransaction: function() {
+		var log = '';
+		return {
+			reset: function() { log = ''; },
+			applyMutations: function(buf, length) {
+				log += buf.toString('binary', 0, length === undefined ? buf.length : length);
+			},
+			set: function(key, value) {
+				log += key.toString() + value.toString();
+			},
+			commit: function(cb) {
+				var committed = log;
+				setImmediate(function() {
+					if(committed.indexOf('bad') !== -1)
+						cb(new FDBError('key_outside_legal_range', 2004));
+					else {
+						commits.push(committed);
+						cb();
+					}
+				});
+			},
+			onError: function(code, cb) {
+				setImmediate(function() { cb(new FDBError('error', code)); });
+			}
+		};
+	}
+};
+
+var db = new Database(nativeDatabase);
+
+function collect(count, done) {
+	var results = {};
+	return function(name) {
+		return function(err) {
+			results[name] = err ? err.code : 'ok';
+			if(--count === 0)
+				done(results);
+		};
+	};
+}
+
+var tests = [
+	function batchesWrites(done) {
+		var result = collect(3, function(results) {
+			assert.deepEqual(results, { a: 'ok', b: 'ok', c: 'ok' });
+			assert.equal(commits.length, 1);
+			done();
+		});
+
+		db.set('a', '1', result('a'));
+		db.clear('b', result('b'));
+		db.set('c', '2', result('c'));
+	},
+
+	function failsOnlyTheRejectedWrite(done) {
+		var result = collect(3, function(results) {
+			assert.deepEqual(results, { a: 'ok', bad: 2004, c: 'ok' });
+			assert.equal(commits.length, 2);
+			assert(commits[0].indexOf('a') !== -1 && commits[1].indexOf('c') !== -1);
+			done();
+		});
+
+		db.set('a', '1', result('a'));
+		db.set('bad', '1', result('bad'));
+		db.set('c', '2', result('c'));
+	},
+
+	function doesNotBatchSystemKeys(done) {
+		var result = collect(2, function(results) {
+			assert.deepEqual(results, { a: 'ok', system: 'ok' });
+			assert.equal(commits.length, 2);
+			done();
+		});
+
+		db.set('a', '1', result('a'));
+		db.set(new Buffer([0xff, 0x01]), '1', result('system'));
+	}
+];
+
+db.setWriteBatching({ maxOps: 10 });
+
+function runTest(index) {
+	if(index === tests.length) {
+		console.log('writeBatcher: ' + tests.length + ' tests passed');
+		return;
+	}
+
+	commits = [];
+	tests[index](function() {
+		runTest(index + 1);
+	});
+}
+
+runTest(0);